@@ -3,6 +3,7 @@
 #include <logging.h>
 
 #include <dir_diff.h>
+#include <diff_session.h>
 #include <content_sources.h>
 #include <file_list_rows.h>
 #include <loaded_text_file.h>
@@ -33,12 +34,14 @@
 #include <QVBoxLayout>
 #include <QWidget>
 #include <QFontDatabase>
-#include <QTextCursor>
-#include <QTextBlock>
 #include <QScrollBar>
+#include <QThreadPool>
 #include <QTimer>
 
 #include <algorithm>
+#include <chrono>
+#include <memory>
+#include <utility>
 
 namespace {
 
@@ -122,35 +125,8 @@ bool refresh_repo_file_list_widget(QListWidget* list,
 int first_visual_row_for_hunk(const bendiff::core::render::RenderDocument& doc,
                               const bendiff::core::navigation::ChangeLocation& loc)
 {
-    const auto leftBegin = loc.leftStart;
-    const auto leftEnd = loc.leftStart + loc.leftCount;
-    const auto rightBegin = loc.rightStart;
-    const auto rightEnd = loc.rightStart + loc.rightCount;
-
-    int visualRow = 0;
-    for (const auto& block : doc.blocks) {
-        for (const auto& line : block.lines) {
-            if (line.op != bendiff::core::diff::LineOp::Equal) {
-                bool matches = false;
-                if (loc.leftCount > 0 && line.leftLine.has_value()) {
-                    const std::size_t idx = *line.leftLine - 1;
-                    matches = matches || (idx >= leftBegin && idx < leftEnd);
-                }
-                if (loc.rightCount > 0 && line.rightLine.has_value()) {
-                    const std::size_t idx = *line.rightLine - 1;
-                    matches = matches || (idx >= rightBegin && idx < rightEnd);
-                }
-                // Pure insert hunks have leftCount == 0; pure delete hunks have rightCount == 0.
-                // Replacements have both; any row belonging to either side is a good scroll target.
-                if (matches) {
-                    return visualRow;
-                }
-            }
-            ++visualRow;
-        }
-    }
-
-    return 0;
+    const auto row = bendiff::core::navigation::FirstRowOfHunk(doc.hunkRows, loc.hunkIndex);
+    return row ? static_cast<int>(*row) : 0;
 }
 
 void scroll_to_visual_row(DiffTextView* view, int visualRow)
@@ -162,14 +138,18 @@ void scroll_to_visual_row(DiffTextView* view, int visualRow)
         visualRow = 0;
     }
 
-    const QTextBlock block = view->document()->findBlockByNumber(visualRow);
-    if (!block.isValid()) {
-        return;
-    }
+    view->scrollToRow(visualRow);
+}
 
-    QTextCursor c(block);
-    view->setTextCursor(c);
-    view->centerCursor();
+bendiff::core::navigation::VisibleRows visible_rows(const DiffTextView* view)
+{
+    if (!view) {
+        return {};
+    }
+    return {
+        .firstRow = static_cast<std::size_t>(view->firstVisibleRow()),
+        .rowCount = static_cast<std::size_t>(view->visibleRowCount()),
+    };
 }
 
 QWidget* make_text_panel(const QString& title, DiffTextView** outText, QWidget* parent)
@@ -261,7 +241,7 @@ bool validate_dir_path(const std::filesystem::path& p)
     return true;
 }
 
-QString format_numbered_lines(const std::vector<std::string>& lines, const QString& marker)
+QString format_numbered_lines(const bendiff::core::TextLines& lines, const QString& marker)
 {
     const int count = static_cast<int>(lines.size());
     const int width = std::max(1, static_cast<int>(QString::number(std::max(1, count)).size()));
@@ -272,7 +252,7 @@ QString format_numbered_lines(const std::vector<std::string>& lines, const QStri
         out += QString("%1 %2 | %3\n")
                    .arg(marker)
                    .arg(i + 1, width)
-                   .arg(QString::fromStdString(lines[static_cast<std::size_t>(i)]));
+                   .arg(QString::fromUtf8(lines[static_cast<std::size_t>(i)]));
     }
     return out;
 }
@@ -316,28 +296,157 @@ bendiff::core::diff::WhitespaceMode to_ws_mode(int comboIndex)
     }
 }
 
-void set_render_doc_inline(DiffTextView* view, const bendiff::core::render::RenderDocument& doc)
+// Budgets for diffs computed while the user waits: pathological inputs get an
+// approximate (but valid) result instead of freezing the window.
+bendiff::core::diff::DiffOptions interactive_diff_options()
+{
+    bendiff::core::diff::DiffOptions options;
+    options.maxEditCost = 20'000;
+    options.timeBudget = std::chrono::milliseconds(2'000);
+    return options;
+}
+
+void set_render_doc_inline(DiffTextView* view, std::shared_ptr<const bendiff::core::render::RenderDocument> doc)
 {
     if (!view) {
         return;
     }
-    view->setRenderDocument(doc, DiffTextView::Mode::Inline);
+    view->setRenderDocument(std::move(doc), DiffTextView::Mode::Inline);
 }
 
-void set_render_doc_sbs_left(DiffTextView* view, const bendiff::core::render::RenderDocument& doc)
+void set_render_doc_sbs_left(DiffTextView* view, std::shared_ptr<const bendiff::core::render::RenderDocument> doc)
 {
     if (!view) {
         return;
     }
-    view->setRenderDocument(doc, DiffTextView::Mode::SideBySideLeft);
+    view->setRenderDocument(std::move(doc), DiffTextView::Mode::SideBySideLeft);
 }
 
-void set_render_doc_sbs_right(DiffTextView* view, const bendiff::core::render::RenderDocument& doc)
+void set_render_doc_sbs_right(DiffTextView* view, std::shared_ptr<const bendiff::core::render::RenderDocument> doc)
 {
     if (!view) {
         return;
     }
-    view->setRenderDocument(doc, DiffTextView::Mode::SideBySideRight);
+    view->setRenderDocument(std::move(doc), DiffTextView::Mode::SideBySideRight);
+}
+
+// Delay before a pending diff job replaces the panes with the "computing"
+// placeholder, so quick diffs don't flicker.
+constexpr int kComputingPlaceholderDelayMs = 150;
+
+struct LoadedSides {
+    bendiff::core::LoadedTextFile left;
+    bendiff::core::LoadedTextFile right;
+};
+
+bool is_unsupported(const bendiff::core::DiffSession& session)
+{
+    return bendiff::core::IsUnsupportedText(session.left()) || bendiff::core::IsUnsupportedText(session.right());
+}
+
+std::shared_ptr<bendiff::core::DiffSession> make_diff_session(LoadedSides sides)
+{
+    return std::make_shared<bendiff::core::DiffSession>(std::move(sides.left), std::move(sides.right));
+}
+
+// Repo mode: HEAD (via `git show`) vs working tree. Runs on a worker thread.
+LoadedSides load_repo_sides(const std::optional<std::filesystem::path>& repoRoot, const bendiff::core::ChangedFile& cf)
+{
+    LoadedSides out;
+    if (!repoRoot.has_value()) {
+        return out;
+    }
+
+    const auto sides = bendiff::core::ResolveRepoContent(*repoRoot, cf);
+
+    if (sides.left.kind == bendiff::core::ContentSource::Kind::FileOnDisk) {
+        out.left = bendiff::core::LoadUtf8TextFile(sides.left.absolutePath);
+    } else if (sides.left.kind == bendiff::core::ContentSource::Kind::Bytes) {
+        out.left = bendiff::core::LoadUtf8TextFromBytes(sides.left.bytes, "HEAD:" + cf.repoRelativePath);
+    } else {
+        out.left.absolutePath.clear();
+        out.left.status = bendiff::core::LoadStatus::NotFound;
+    }
+
+    if (sides.right.kind == bendiff::core::ContentSource::Kind::FileOnDisk) {
+        out.right = bendiff::core::LoadUtf8TextFile(sides.right.absolutePath);
+    } else if (sides.right.kind == bendiff::core::ContentSource::Kind::Bytes) {
+        out.right = bendiff::core::LoadUtf8TextFromBytes(sides.right.bytes, sides.right.absolutePath);
+    } else {
+        out.right.absolutePath.clear();
+        out.right.status = bendiff::core::LoadStatus::NotFound;
+    }
+
+    return out;
+}
+
+// Folder mode: both sides from disk; an empty path means the side is missing.
+// Runs on a worker thread.
+LoadedSides load_folder_sides(const QString& leftFull, const QString& rightFull)
+{
+    LoadedSides out;
+    if (!leftFull.isEmpty()) {
+        out.left = bendiff::core::LoadUtf8TextFile(std::filesystem::path(leftFull.toStdString()));
+    } else {
+        out.left.status = bendiff::core::LoadStatus::NotFound;
+    }
+    if (!rightFull.isEmpty()) {
+        out.right = bendiff::core::LoadUtf8TextFile(std::filesystem::path(rightFull.toStdString()));
+    } else {
+        out.right.status = bendiff::core::LoadStatus::NotFound;
+    }
+    return out;
+}
+
+// Diffs (or looks up the session's memoized diff) and renders the loaded
+// sides, or builds the unsupported-content texts. Runs on a worker thread and
+// gives up as soon as `stop` is requested.
+DiffJobResult compute_diff_job(const std::shared_ptr<bendiff::core::DiffSession>& session,
+                               const QString& sessionKey,
+                               const QString& detail,
+                               bool inlineMode,
+                               bendiff::core::diff::WhitespaceMode mode,
+                               std::stop_token stop)
+{
+    DiffJobResult out;
+    out.inlineMode = inlineMode;
+    out.sessionKey = sessionKey;
+    out.session = session;
+
+    if (stop.stop_requested()) {
+        out.cancelled = true;
+        return out;
+    }
+
+    const auto& sides = *session;
+    if (is_unsupported(sides)) {
+        out.unsupported = true;
+        if (inlineMode) {
+            out.textA = QString("Unsupported\n\n%1\n\n(left) %2\n\n(right) %3")
+                            .arg(detail)
+                            .arg(render_loaded_text(sides.left(), " "))
+                            .arg(render_loaded_text(sides.right(), " "));
+        } else {
+            out.textA = QString("Unsupported (left)\n\n%1\n\n%2").arg(detail).arg(render_loaded_text(sides.left(), " "));
+            out.textB = QString("Unsupported (right)\n\n%1\n\n%2").arg(detail).arg(render_loaded_text(sides.right(), " "));
+        }
+        return out;
+    }
+
+    auto options = interactive_diff_options();
+    options.control.stop = stop;
+    auto d = session->Diff(mode, options);
+    if (d.cancelled) {
+        out.cancelled = true;
+        return out;
+    }
+
+    // Lazy: O(hunks) to build, and the panes only build the rows they paint.
+    auto doc = bendiff::core::render::BuildLazyRender(sides.left(), sides.right(), d);
+
+    out.diff = std::move(d);
+    out.renderDoc = std::make_shared<const bendiff::core::render::RenderDocument>(std::move(doc));
+    return out;
 }
 
 } // namespace
@@ -348,6 +457,17 @@ MainWindow::MainWindow(const bendiff::Invocation& invocation, QWidget* parent)
 {
     setWindowTitle("BenDiff");
 
+    // Background diff pipeline: jobs run on the pool and hand their result
+    // back to the GUI thread through a queued signal.
+    m_diffPool = new QThreadPool(this);
+    m_diffPool->setMaxThreadCount(2);
+    connect(this, &MainWindow::diffJobFinished, this, &MainWindow::apply_diff_job, Qt::QueuedConnection);
+
+    // Folder compares (and the hash cache I/O around them), one at a time.
+    m_folderPool = new QThreadPool(this);
+    m_folderPool->setMaxThreadCount(1);
+    connect(this, &MainWindow::folderDiffFinished, this, &MainWindow::apply_folder_diff, Qt::QueuedConnection);
+
     setup_menus();
     setup_toolbar();
     setup_central();
@@ -366,6 +486,90 @@ MainWindow::MainWindow(const bendiff::Invocation& invocation, QWidget* parent)
     update_repo_auto_refresh_timer();
 }
 
+MainWindow::~MainWindow()
+{
+    // Jobs deliver results to this window: stop them and wait for the pool
+    // before tearing anything down.
+    cancel_diff_job();
+    if (m_diffPool) {
+        m_diffPool->waitForDone();
+    }
+    // Also lets a pending hash cache save finish.
+    if (m_folderPool) {
+        m_folderPool->waitForDone();
+    }
+}
+
+void MainWindow::start_diff_job(std::function<DiffJobResult(std::stop_token)> job)
+{
+    // Latest request wins: the running job (if any) is stopped, and whatever
+    // it still delivers is ignored because its generation is stale.
+    cancel_diff_job();
+    const quint64 generation = m_diffGeneration;
+
+    m_currentDiff.reset();
+    m_currentRenderDoc.reset();
+    m_currentChanges.clear();
+    m_currentChangeIndex.reset();
+    m_currentSelectionUnsupported = false;
+    m_diffPending = true;
+
+    QTimer::singleShot(kComputingPlaceholderDelayMs, this, [this, generation] {
+        if (!m_diffPending || generation != m_diffGeneration) {
+            return;
+        }
+        set_text(m_diffTextA, QStringLiteral("Computing diff\u2026"));
+        set_text(m_diffTextB, m_paneMode == PaneMode::Inline ? QString() : QStringLiteral("Computing diff\u2026"));
+    });
+
+    m_diffPool->start([this, generation, job = std::move(job), stop = m_diffStop.get_token()] {
+        auto result = std::make_shared<DiffJobResult>(job(stop));
+        emit diffJobFinished(generation, std::move(result));
+    });
+}
+
+void MainWindow::cancel_diff_job()
+{
+    m_diffStop.request_stop();
+    m_diffStop = std::stop_source();
+    ++m_diffGeneration;
+    m_diffPending = false;
+}
+
+void MainWindow::apply_diff_job(quint64 generation, std::shared_ptr<DiffJobResult> result)
+{
+    if (generation != m_diffGeneration || !result || result->cancelled) {
+        return;
+    }
+    m_diffPending = false;
+
+    if (m_diffTextA && m_diffTextB) {
+        if (!result->renderDoc) {
+            set_text(m_diffTextA, result->textA);
+            set_text(m_diffTextB, result->textB);
+        } else if (result->inlineMode) {
+            set_render_doc_inline(m_diffTextA, result->renderDoc);
+            set_text(m_diffTextB, QString());
+        } else {
+            set_render_doc_sbs_left(m_diffTextA, result->renderDoc);
+            set_render_doc_sbs_right(m_diffTextB, result->renderDoc);
+        }
+    }
+
+    m_diffSession = std::move(result->session);
+    m_diffSessionKey = result->sessionKey;
+
+    m_currentSelectionUnsupported = result->unsupported;
+    if (result->diff.has_value()) {
+        m_currentChanges = bendiff::core::navigation::EnumerateChangeHunks(*result->diff);
+        m_currentDiff = std::move(result->diff);
+        m_currentRenderDoc = std::move(result->renderDoc);
+    }
+    m_currentChangeIndex.reset();
+
+    update_status_bar();
+}
+
 void MainWindow::setup_menus()
 {
     auto* fileMenu = menuBar()->addMenu("&File");
@@ -479,18 +683,21 @@ void MainWindow::setup_toolbar()
         repo_auto_refresh_tick(/*force=*/true);
     });
     connect(m_actionNextChange, &QAction::triggered, this, [this] {
-        if (!m_currentRenderDoc.has_value() || m_currentChanges.empty()) {
+        if (!m_currentRenderDoc || m_currentChanges.empty()) {
             update_status_bar();
             return;
         }
 
-        const auto next = bendiff::core::navigation::NextChangeIndex(m_currentChangeIndex, m_currentChanges);
-        if (next.has_value()) {
-            m_currentChangeIndex = *next;
-        } else {
-            // Wrap so repeated Next cycles through hunks.
-            m_currentChangeIndex = 0;
+        // Step from the current hunk while it is on screen, else from where
+        // the user has scrolled to.
+        const auto next = bendiff::core::navigation::NextHunkFromView(m_currentRenderDoc->hunkRows,
+                                                                         m_currentChangeIndex,
+                                                                         visible_rows(m_diffTextA));
+        if (!next.has_value() || *next >= m_currentChanges.size()) {
+            update_status_bar();
+            return;
         }
+        m_currentChangeIndex = *next;
 
         const auto& loc = m_currentChanges[*m_currentChangeIndex];
         const int row = first_visual_row_for_hunk(*m_currentRenderDoc, loc);
@@ -505,18 +712,21 @@ void MainWindow::setup_toolbar()
         update_status_bar();
     });
     connect(m_actionPrevChange, &QAction::triggered, this, [this] {
-        if (!m_currentRenderDoc.has_value() || m_currentChanges.empty()) {
+        if (!m_currentRenderDoc || m_currentChanges.empty()) {
             update_status_bar();
             return;
         }
 
-        const auto prev = bendiff::core::navigation::PrevChangeIndex(m_currentChangeIndex, m_currentChanges);
-        if (prev.has_value()) {
-            m_currentChangeIndex = *prev;
-        } else {
-            // Wrap so repeated Prev cycles through hunks.
-            m_currentChangeIndex = m_currentChanges.size() - 1;
+        // Step from the current hunk while it is on screen, else from where
+        // the user has scrolled to.
+        const auto prev = bendiff::core::navigation::PrevHunkFromView(m_currentRenderDoc->hunkRows,
+                                                                         m_currentChangeIndex,
+                                                                         visible_rows(m_diffTextA));
+        if (!prev.has_value() || *prev >= m_currentChanges.size()) {
+            update_status_bar();
+            return;
         }
+        m_currentChangeIndex = *prev;
 
         const auto& loc = m_currentChanges[*m_currentChangeIndex];
         const int row = first_visual_row_for_hunk(*m_currentRenderDoc, loc);
@@ -534,20 +744,10 @@ void MainWindow::setup_toolbar()
     connect(m_whitespaceCombo, &QComboBox::currentTextChanged, this, [this](const QString& text) {
         bendiff::logging::info(std::string("Whitespace mode set to: ") + text.toStdString());
 
-        // M6-T8: changing whitespace mode must re-diff and re-render.
-        // We do this by re-triggering the current selection handler.
-        if (!m_fileListWidget) {
-            return;
-        }
-        const int row = m_fileListWidget->currentRow();
-        if (row < 0) {
-            return;
-        }
-
-        m_fileListWidget->blockSignals(true);
-        m_fileListWidget->setCurrentRow(-1);
-        m_fileListWidget->blockSignals(false);
-        m_fileListWidget->setCurrentRow(row);
+        // M6-T8: changing whitespace mode must re-diff and re-render. The
+        // selection's diff session keeps the loaded sides and every mode's
+        // diff, so only a mode not seen before runs the diff again.
+        rerun_current_selection();
     });
 
     connect(m_actionInlineMode, &QAction::triggered, this, [this] {
@@ -675,36 +875,11 @@ void MainWindow::setup_central()
                 const auto kind = static_cast<bendiff::core::ChangeKind>(kindInt);
                 bendiff::logging::info(std::string("Selected repo file: ") + path.toStdString() + " kind=" + to_string(kind));
 
-                // M4-T4: binary/unsupported detection.
-                bendiff::core::LoadedTextFile leftLoaded;
-                bendiff::core::LoadedTextFile rightLoaded;
-                if (m_repoRoot.has_value()) {
-                    bendiff::core::ChangedFile cf;
-                    cf.repoRelativePath = path.toStdString();
-                    cf.kind = kind;
-                    if (!renameFrom.isEmpty()) {
-                        cf.renameFrom = renameFrom.toStdString();
-                    }
-
-                    const auto sides = bendiff::core::ResolveRepoContent(*m_repoRoot, cf);
-
-                    if (sides.left.kind == bendiff::core::ContentSource::Kind::FileOnDisk) {
-                        leftLoaded = bendiff::core::LoadUtf8TextFile(sides.left.absolutePath);
-                    } else if (sides.left.kind == bendiff::core::ContentSource::Kind::Bytes) {
-                        leftLoaded = bendiff::core::LoadUtf8TextFromBytes(sides.left.bytes, "HEAD:" + cf.repoRelativePath);
-                    } else {
-                        leftLoaded.absolutePath.clear();
-                        leftLoaded.status = bendiff::core::LoadStatus::NotFound;
-                    }
-
-                    if (sides.right.kind == bendiff::core::ContentSource::Kind::FileOnDisk) {
-                        rightLoaded = bendiff::core::LoadUtf8TextFile(sides.right.absolutePath);
-                    } else if (sides.right.kind == bendiff::core::ContentSource::Kind::Bytes) {
-                        rightLoaded = bendiff::core::LoadUtf8TextFromBytes(sides.right.bytes, sides.right.absolutePath);
-                    } else {
-                        rightLoaded.absolutePath.clear();
-                        rightLoaded.status = bendiff::core::LoadStatus::NotFound;
-                    }
+                bendiff::core::ChangedFile cf;
+                cf.repoRelativePath = path.toStdString();
+                cf.kind = kind;
+                if (!renameFrom.isEmpty()) {
+                    cf.renameFrom = renameFrom.toStdString();
                 }
 
                 QString detail = QString("%1\nKind: %2").arg(path).arg(to_string(kind));
@@ -712,69 +887,23 @@ void MainWindow::setup_central()
                     detail += QString("\nRenamed from: %1").arg(renameFrom);
                 }
 
-                const bool unsupported = bendiff::core::IsUnsupportedText(leftLoaded) || bendiff::core::IsUnsupportedText(rightLoaded);
-                if (unsupported) {
-                    detail += "\n\nBinary/Unsupported (non-UTF-8)";
-                }
+                const bool inlineMode = (m_paneMode == PaneMode::Inline);
+                const auto mode = to_ws_mode(m_whitespaceCombo ? m_whitespaceCombo->currentIndex() : 0);
+
+                const QString sessionKey = QString("%1\n%2\n%3").arg(path).arg(kindInt).arg(renameFrom);
+                auto session = take_reusable_diff_session(sessionKey);
+
+                start_diff_job([repoRoot = m_repoRoot, cf, detail, inlineMode, mode, sessionKey, session](std::stop_token stop) {
+                    const auto s = session ? session : make_diff_session(load_repo_sides(repoRoot, cf));
 
-                if (m_diffTextA && m_diffTextB) {
-                    if (m_paneMode == PaneMode::Inline) {
-                        if (unsupported) {
-                            set_text(m_diffTextA, QString("Unsupported\n\n%1\n\n(left) %2\n\n(right) %3")
-                                                   .arg(detail)
-                                                   .arg(render_loaded_text(leftLoaded, " "))
-                                                   .arg(render_loaded_text(rightLoaded, " ")));
-                            set_text(m_diffTextB, QString());
-                            m_currentDiff.reset();
-                            m_currentRenderDoc.reset();
-                            m_currentChanges.clear();
-                            m_currentChangeIndex.reset();
-                            m_currentSelectionUnsupported = true;
-                            updateStatus();
-                            return;
-                        }
-
-                        const auto mode = to_ws_mode(m_whitespaceCombo ? m_whitespaceCombo->currentIndex() : 0);
-                        const auto d = bendiff::core::diff::DiffLines(leftLoaded.lines, rightLoaded.lines, mode);
-                        const auto doc = bendiff::core::render::BuildInlineRender(leftLoaded, rightLoaded, d);
-
-                        set_render_doc_inline(m_diffTextA, doc);
-                        set_text(m_diffTextB, QString());
-
-                        m_currentDiff = d;
-                        m_currentRenderDoc = doc;
-                        m_currentChanges = bendiff::core::navigation::EnumerateChangeHunks(d);
-                        m_currentChangeIndex.reset();
-                        m_currentSelectionUnsupported = false;
-                        updateStatus();
-                    } else {
-                        if (unsupported) {
-                            set_text(m_diffTextA, QString("Unsupported (left)\n\n%1\n\n%2").arg(detail).arg(render_loaded_text(leftLoaded, " ")));
-                            set_text(m_diffTextB, QString("Unsupported (right)\n\n%1\n\n%2").arg(detail).arg(render_loaded_text(rightLoaded, " ")));
-                            m_currentDiff.reset();
-                            m_currentRenderDoc.reset();
-                            m_currentChanges.clear();
-                            m_currentChangeIndex.reset();
-                            m_currentSelectionUnsupported = true;
-                            updateStatus();
-                            return;
-                        }
-
-                        const auto mode = to_ws_mode(m_whitespaceCombo ? m_whitespaceCombo->currentIndex() : 0);
-                        const auto d = bendiff::core::diff::DiffLines(leftLoaded.lines, rightLoaded.lines, mode);
-                        const auto doc = bendiff::core::render::BuildSideBySideRender(leftLoaded, rightLoaded, d);
-
-                        set_render_doc_sbs_left(m_diffTextA, doc);
-                        set_render_doc_sbs_right(m_diffTextB, doc);
-
-                        m_currentDiff = d;
-                        m_currentRenderDoc = doc;
-                        m_currentChanges = bendiff::core::navigation::EnumerateChangeHunks(d);
-                        m_currentChangeIndex.reset();
-                        m_currentSelectionUnsupported = false;
-                        updateStatus();
+                    // M4-T4: binary/unsupported detection.
+                    QString fullDetail = detail;
+                    if (is_unsupported(*s)) {
+                        fullDetail += "\n\nBinary/Unsupported (non-UTF-8)";
                     }
-                }
+                    return compute_diff_job(s, sessionKey, fullDetail, inlineMode, mode, stop);
+                });
+                updateStatus();
             } else if (m_invocation.mode == bendiff::AppMode::FolderDiffMode) {
                 const QString rel = current->data(Qt::UserRole).toString();
                 const int statusInt = current->data(Qt::UserRole + 1).toInt();
@@ -790,83 +919,24 @@ void MainWindow::setup_central()
                 const auto status = static_cast<bendiff::core::DirEntryStatus>(statusInt);
                 bendiff::logging::info(std::string("Selected folder entry: ") + rel.toStdString() + " status=" + to_string(status));
 
-                // M4-T4: show unsupported if either side is non-UTF-8.
-                bendiff::core::LoadedTextFile leftLoaded;
-                bendiff::core::LoadedTextFile rightLoaded;
-                if (!leftFull.isEmpty()) {
-                    leftLoaded = bendiff::core::LoadUtf8TextFile(std::filesystem::path(leftFull.toStdString()));
-                } else {
-                    leftLoaded.status = bendiff::core::LoadStatus::NotFound;
-                }
-                if (!rightFull.isEmpty()) {
-                    rightLoaded = bendiff::core::LoadUtf8TextFile(std::filesystem::path(rightFull.toStdString()));
-                } else {
-                    rightLoaded.status = bendiff::core::LoadStatus::NotFound;
-                }
-                const bool unsupported = bendiff::core::IsUnsupportedText(leftLoaded) || bendiff::core::IsUnsupportedText(rightLoaded);
-
                 const QString detail = QString("%1\nStatus: %2\n\nLeft: %3\nRight: %4")
                                            .arg(rel)
                                            .arg(to_string(status))
                                            .arg(leftFull.isEmpty() ? QString("(missing)") : leftFull)
                                            .arg(rightFull.isEmpty() ? QString("(missing)") : rightFull);
 
-                if (m_diffTextA && m_diffTextB) {
-                    if (m_paneMode == PaneMode::Inline) {
-                        if (unsupported) {
-                            set_text(m_diffTextA, QString("Unsupported\n\n%1\n\n(left) %2\n\n(right) %3")
-                                                   .arg(detail)
-                                                   .arg(render_loaded_text(leftLoaded, " "))
-                                                   .arg(render_loaded_text(rightLoaded, " ")));
-                            set_text(m_diffTextB, QString());
-                            m_currentDiff.reset();
-                            m_currentRenderDoc.reset();
-                            m_currentChanges.clear();
-                            m_currentChangeIndex.reset();
-                            m_currentSelectionUnsupported = true;
-                            updateStatus();
-                            return;
-                        }
-
-                        const auto mode = to_ws_mode(m_whitespaceCombo ? m_whitespaceCombo->currentIndex() : 0);
-                        const auto d = bendiff::core::diff::DiffLines(leftLoaded.lines, rightLoaded.lines, mode);
-                        const auto doc = bendiff::core::render::BuildInlineRender(leftLoaded, rightLoaded, d);
-                        set_render_doc_inline(m_diffTextA, doc);
-                        set_text(m_diffTextB, QString());
-
-                        m_currentDiff = d;
-                        m_currentRenderDoc = doc;
-                        m_currentChanges = bendiff::core::navigation::EnumerateChangeHunks(d);
-                        m_currentChangeIndex.reset();
-                        m_currentSelectionUnsupported = false;
-                        updateStatus();
-                    } else {
-                        if (unsupported) {
-                            set_text(m_diffTextA, QString("Unsupported (left)\n\n%1\n\n%2").arg(detail).arg(render_loaded_text(leftLoaded, " ")));
-                            set_text(m_diffTextB, QString("Unsupported (right)\n\n%1\n\n%2").arg(detail).arg(render_loaded_text(rightLoaded, " ")));
-                            m_currentDiff.reset();
-                            m_currentRenderDoc.reset();
-                            m_currentChanges.clear();
-                            m_currentChangeIndex.reset();
-                            m_currentSelectionUnsupported = true;
-                            updateStatus();
-                            return;
-                        }
-
-                        const auto mode = to_ws_mode(m_whitespaceCombo ? m_whitespaceCombo->currentIndex() : 0);
-                        const auto d = bendiff::core::diff::DiffLines(leftLoaded.lines, rightLoaded.lines, mode);
-                        const auto doc = bendiff::core::render::BuildSideBySideRender(leftLoaded, rightLoaded, d);
-                        set_render_doc_sbs_left(m_diffTextA, doc);
-                        set_render_doc_sbs_right(m_diffTextB, doc);
-
-                        m_currentDiff = d;
-                        m_currentRenderDoc = doc;
-                        m_currentChanges = bendiff::core::navigation::EnumerateChangeHunks(d);
-                        m_currentChangeIndex.reset();
-                        m_currentSelectionUnsupported = false;
-                        updateStatus();
-                    }
-                }
+                const bool inlineMode = (m_paneMode == PaneMode::Inline);
+                const auto mode = to_ws_mode(m_whitespaceCombo ? m_whitespaceCombo->currentIndex() : 0);
+
+                const QString sessionKey = QString("%1\n%2").arg(leftFull).arg(rightFull);
+                auto session = take_reusable_diff_session(sessionKey);
+
+                start_diff_job([leftFull, rightFull, detail, inlineMode, mode, sessionKey, session](std::stop_token stop) {
+                    // M4-T4: show unsupported if either side is non-UTF-8.
+                    const auto s = session ? session : make_diff_session(load_folder_sides(leftFull, rightFull));
+                    return compute_diff_job(s, sessionKey, detail, inlineMode, mode, stop);
+                });
+                updateStatus();
             } else {
                 reset_placeholders();
                 updateStatus();
@@ -969,6 +1039,13 @@ void MainWindow::enter_folder_diff_mode(const std::filesystem::path& leftPath, c
 
 void MainWindow::refresh_file_list()
 {
+    // Files may have changed on disk; the next selection reloads them.
+    m_diffSession.reset();
+    m_diffSessionKey.clear();
+
+    // Whatever a folder compare still running would deliver is stale now.
+    ++m_folderGeneration;
+
     if (!m_fileListWidget) {
         return;
     }
@@ -1025,45 +1102,86 @@ void MainWindow::refresh_file_list()
             return;
         }
 
-        const auto diff = bendiff::core::DiffDirectories(m_invocation.leftPath, m_invocation.rightPath);
-        for (const auto& e : diff.entries) {
-            const QString rel = QString::fromStdString(e.relativePath);
-            const QString statusText = QString::fromLatin1(to_string(e.status));
+        // The compare reads the files, and the hash cache file is read before
+        // it and written after it: all on the folder pool, which runs one job
+        // at a time so passes never overlap on the cache. The list fills in
+        // when the job is done (apply_folder_diff).
+        const bool loadCache = !m_hashCache;
+        if (loadCache) {
+            m_hashCache = std::make_shared<bendiff::core::ContentHashCache>(bendiff::core::ContentHashCache::DefaultFile());
+        }
+        auto* placeholder = new QListWidgetItem(QStringLiteral("(comparing folders\u2026)"));
+        placeholder->setFlags(placeholder->flags() & ~Qt::ItemIsSelectable);
+        m_fileListWidget->addItem(placeholder);
+        m_folderPool->start([this,
+                             generation = m_folderGeneration,
+                             cache = m_hashCache,
+                             loadCache,
+                             leftPath = m_invocation.leftPath,
+                             rightPath = m_invocation.rightPath] {
+            if (loadCache) {
+                (void)cache->Load();
+            }
+            auto diff = std::make_shared<const bendiff::core::DirDiffResult>(
+                bendiff::core::DiffDirectories(leftPath, rightPath, {.hashCache = cache.get()}));
+            if (!cache->Save()) {
+                bendiff::logging::warn("Could not save the content hash cache: " + cache->file().string());
+            }
+            emit folderDiffFinished(generation, std::move(diff));
+        });
+    } else {
+        m_fileListWidget->addItem("(no mode selected)");
+    }
+
+    m_fileListWidget->blockSignals(false);
+}
 
-            QString display = rel;
-            display += QString(" [%1]").arg(statusText);
+void MainWindow::apply_folder_diff(quint64 generation, std::shared_ptr<const bendiff::core::DirDiffResult> result)
+{
+    // A later refresh (or a mode change) superseded this one.
+    if (generation != m_folderGeneration || !result || !m_fileListWidget) {
+        return;
+    }
 
-            auto* item = new QListWidgetItem(display);
+    const auto& diff = *result;
+    m_fileListWidget->blockSignals(true);
+    m_fileListWidget->clear();
+    for (const auto& e : diff.entries) {
+        const std::string_view relPath = e.relativePath();
+        const QString rel = QString::fromUtf8(relPath.data(), static_cast<qsizetype>(relPath.size()));
+        const QString statusText = QString::fromLatin1(to_string(e.status));
 
-            // Store metadata for selection handling.
-            item->setData(Qt::UserRole, rel);
-            item->setData(Qt::UserRole + 1, static_cast<int>(e.status));
+        QString display = rel;
+        display += QString(" [%1]").arg(statusText);
 
-            const std::filesystem::path leftFull = diff.leftRoot / std::filesystem::path(e.relativePath).make_preferred();
-            const std::filesystem::path rightFull = diff.rightRoot / std::filesystem::path(e.relativePath).make_preferred();
+        auto* item = new QListWidgetItem(display);
 
-            if (e.status == bendiff::core::DirEntryStatus::RightOnly) {
-                item->setData(Qt::UserRole + 2, QString());
-                item->setData(Qt::UserRole + 3, QString::fromStdString(rightFull.string()));
-            } else if (e.status == bendiff::core::DirEntryStatus::LeftOnly) {
-                item->setData(Qt::UserRole + 2, QString::fromStdString(leftFull.string()));
-                item->setData(Qt::UserRole + 3, QString());
-            } else {
-                item->setData(Qt::UserRole + 2, QString::fromStdString(leftFull.string()));
-                item->setData(Qt::UserRole + 3, QString::fromStdString(rightFull.string()));
-            }
+        // Store metadata for selection handling.
+        item->setData(Qt::UserRole, rel);
+        item->setData(Qt::UserRole + 1, static_cast<int>(e.status));
 
-            // Visual hint for status.
-            if (e.status == bendiff::core::DirEntryStatus::Different) {
-                item->setForeground(QBrush(QColor(120, 60, 0)));
-            } else if (e.status == bendiff::core::DirEntryStatus::Unreadable) {
-                item->setForeground(QBrush(QColor(160, 0, 0)));
-            }
+        const std::filesystem::path leftFull = diff.leftRoot / std::filesystem::path(relPath).make_preferred();
+        const std::filesystem::path rightFull = diff.rightRoot / std::filesystem::path(relPath).make_preferred();
 
-            m_fileListWidget->addItem(item);
+        if (e.status == bendiff::core::DirEntryStatus::RightOnly) {
+            item->setData(Qt::UserRole + 2, QString());
+            item->setData(Qt::UserRole + 3, QString::fromStdString(rightFull.string()));
+        } else if (e.status == bendiff::core::DirEntryStatus::LeftOnly) {
+            item->setData(Qt::UserRole + 2, QString::fromStdString(leftFull.string()));
+            item->setData(Qt::UserRole + 3, QString());
+        } else {
+            item->setData(Qt::UserRole + 2, QString::fromStdString(leftFull.string()));
+            item->setData(Qt::UserRole + 3, QString::fromStdString(rightFull.string()));
         }
-    } else {
-        m_fileListWidget->addItem("(no mode selected)");
+
+        // Visual hint for status.
+        if (e.status == bendiff::core::DirEntryStatus::Different) {
+            item->setForeground(QBrush(QColor(120, 60, 0)));
+        } else if (e.status == bendiff::core::DirEntryStatus::Unreadable) {
+            item->setForeground(QBrush(QColor(160, 0, 0)));
+        }
+
+        m_fileListWidget->addItem(item);
     }
 
     m_fileListWidget->blockSignals(false);
@@ -1233,6 +1351,7 @@ void MainWindow::repo_auto_refresh_tick(bool force)
 void MainWindow::reset_placeholders()
 {
     // No real logic yet; just keep the UI consistent and visibly reset.
+    cancel_diff_job();
 
     if (m_fileListWidget) {
         m_fileListWidget->clearSelection();
@@ -1256,6 +1375,33 @@ void MainWindow::reset_placeholders()
     m_currentSelectionUnsupported = false;
 }
 
+void MainWindow::rerun_current_selection()
+{
+    if (!m_fileListWidget) {
+        return;
+    }
+    const int row = m_fileListWidget->currentRow();
+    if (row < 0) {
+        return;
+    }
+
+    m_reuseDiffSession = true;
+    m_fileListWidget->blockSignals(true);
+    m_fileListWidget->setCurrentRow(-1);
+    m_fileListWidget->blockSignals(false);
+    m_fileListWidget->setCurrentRow(row);
+    m_reuseDiffSession = false;
+}
+
+std::shared_ptr<bendiff::core::DiffSession> MainWindow::take_reusable_diff_session(const QString& key)
+{
+    const bool reuse = std::exchange(m_reuseDiffSession, false);
+    if (!reuse || !m_diffSession || m_diffSessionKey != key) {
+        return nullptr;
+    }
+    return m_diffSession;
+}
+
 void MainWindow::set_pane_mode(PaneMode mode)
 {
     m_paneMode = mode;
@@ -1275,13 +1421,7 @@ void MainWindow::set_pane_mode(PaneMode mode)
 
     // Force a re-render for the currently-selected item, since the view mode
     // affects how we populate the panes.
-    if (m_fileListWidget && m_fileListWidget->currentRow() >= 0) {
-        const int row = m_fileListWidget->currentRow();
-        m_fileListWidget->blockSignals(true);
-        m_fileListWidget->setCurrentRow(-1);
-        m_fileListWidget->blockSignals(false);
-        m_fileListWidget->setCurrentRow(row);
-    }
+    rerun_current_selection();
 
     // If nothing is selected, ensure the viewers reflect the new topology.
     if (!m_fileListWidget || m_fileListWidget->currentRow() < 0) {
@@ -1345,7 +1485,9 @@ void MainWindow::update_status_bar()
     }
 
     // Diff stats (when relevant).
-    if (m_currentSelectionUnsupported) {
+    if (m_diffPending) {
+        message += QStringLiteral(" | Computing diff\u2026");
+    } else if (m_currentSelectionUnsupported) {
         message += " | Binary/unsupported";
     } else if (m_currentDiff.has_value()) {
         const auto stats = bendiff::core::diff::ComputeDiffStats(*m_currentDiff);
@@ -1357,6 +1499,9 @@ void MainWindow::update_status_bar()
                            .arg(static_cast<qulonglong>(stats.addedLineCount))
                            .arg(static_cast<qulonglong>(stats.deletedLineCount));
         }
+        if (m_currentDiff->approximate) {
+            message += " (approximate)";
+        }
     }
 
     if (m_currentChangeIndex.has_value() && !m_currentChanges.empty()) {
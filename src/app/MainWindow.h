@@ -2,30 +2,65 @@
 
 #include <QMainWindow>
 
+#include <content_hash_cache.h>
 #include <diff/diff.h>
+#include <diff_session.h>
+#include <dir_diff_model.h>
 #include <navigation/change_navigation.h>
 #include <render/diff_render_model.h>
 
 #include <invocation.h>
 
+#include <QString>
+
+#include <functional>
+#include <memory>
 #include <optional>
+#include <stop_token>
 #include <vector>
 
 class QAction;
 class QComboBox;
 class QListWidget;
 class QSplitter;
+class QThreadPool;
 class QTimer;
 class QWidget;
 
 class DiffTextView;
 
+// Output of a background diff job: the diff and its render document, or (for
+// unsupported content) the texts to show in the panes instead. `session` holds
+// the loaded sides and per-mode diffs for the selection named by `sessionKey`.
+struct DiffJobResult {
+    bool cancelled = false;
+    bool inlineMode = true;
+    bool unsupported = false;
+
+    QString textA;
+    QString textB;
+
+    QString sessionKey;
+    std::shared_ptr<bendiff::core::DiffSession> session;
+
+    std::optional<bendiff::core::diff::DiffResult> diff;
+    std::shared_ptr<const bendiff::core::render::RenderDocument> renderDoc;
+};
+
 class MainWindow final : public QMainWindow
 {
     Q_OBJECT
 
 public:
     explicit MainWindow(const bendiff::Invocation& invocation, QWidget* parent = nullptr);
+    ~MainWindow() override;
+
+signals:
+    // Emitted on a worker thread when a diff job finishes (or gives up).
+    void diffJobFinished(quint64 generation, std::shared_ptr<DiffJobResult> result);
+
+    // Emitted on a worker thread when a folder compare finishes.
+    void folderDiffFinished(quint64 generation, std::shared_ptr<const bendiff::core::DirDiffResult> result);
 
 private:
     enum class PaneMode {
@@ -48,8 +83,23 @@ private:
     void repo_auto_refresh_tick(bool force);
 
     void set_pane_mode(PaneMode mode);
+
+    // Re-runs the selection handler for the current row (after a whitespace
+    // or pane mode change), reusing its diff session instead of reloading.
+    void rerun_current_selection();
+
+    // The session to reuse for `key`, or null if the sides must be (re)loaded.
+    // Consumes the reuse request made by rerun_current_selection().
+    std::shared_ptr<bendiff::core::DiffSession> take_reusable_diff_session(const QString& key);
     void update_status_bar();
 
+    // Runs `job` (load + diff + render) on the diff pool and applies its
+    // result unless a newer job was started or the selection was reset.
+    void start_diff_job(std::function<DiffJobResult(std::stop_token)> job);
+    void cancel_diff_job();
+    void apply_diff_job(quint64 generation, std::shared_ptr<DiffJobResult> result);
+    void apply_folder_diff(quint64 generation, std::shared_ptr<const bendiff::core::DirDiffResult> result);
+
     bendiff::Invocation m_invocation;
     PaneMode m_paneMode = PaneMode::Inline;
 
@@ -85,9 +135,32 @@ private:
 
     // M7: cached navigation state for the currently selected item.
     std::optional<bendiff::core::diff::DiffResult> m_currentDiff;
-    std::optional<bendiff::core::render::RenderDocument> m_currentRenderDoc;
+    std::shared_ptr<const bendiff::core::render::RenderDocument> m_currentRenderDoc;
     std::vector<bendiff::core::navigation::ChangeLocation> m_currentChanges;
     std::optional<std::size_t> m_currentChangeIndex;
 
     bool m_currentSelectionUnsupported = false;
+
+    // Loaded sides and memoized diffs for the last applied selection, so mode
+    // toggles don't reload or re-diff. Dropped whenever the file list is
+    // refreshed, since the content may have changed on disk.
+    std::shared_ptr<bendiff::core::DiffSession> m_diffSession;
+    QString m_diffSessionKey;
+    bool m_reuseDiffSession = false;
+
+    // Folder mode: content hashes from earlier runs, loaded by the first
+    // folder compare and saved after each (on the folder pool), so a refresh
+    // only reads files whose metadata changed. Shared with running jobs.
+    std::shared_ptr<bendiff::core::ContentHashCache> m_hashCache;
+
+    // Folder compares run here, one at a time; results from before the
+    // latest refresh_file_list() are dropped.
+    QThreadPool* m_folderPool = nullptr;
+    quint64 m_folderGeneration = 0;
+
+    // Background diff pipeline state (GUI thread only).
+    QThreadPool* m_diffPool = nullptr;
+    std::stop_source m_diffStop;
+    quint64 m_diffGeneration = 0;
+    bool m_diffPending = false;
 };
@@ -1,24 +1,407 @@
 #include "DiffTextView.h"
 
+#include <QClipboard>
 #include <QFontDatabase>
-#include <QTextBlock>
-#include <QTextCursor>
+#include <QGuiApplication>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QTextOption>
 
 #include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace {
+
+// Horizontal padding around the gutter text and before the row text.
+constexpr int kTextMargin = 6;
+
+// Width of the rect row text is drawn into; wide enough for any line, the
+// painter clips to the viewport anyway.
+constexpr int kMaxRowPixels = 1 << 24;
+
+} // namespace
 
 DiffTextView::DiffTextView(QWidget* parent)
-    : QPlainTextEdit(parent)
+    : QAbstractScrollArea(parent)
 {
-    setReadOnly(true);
-    setLineWrapMode(QPlainTextEdit::NoWrap);
     setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+    updateMetrics();
+}
+
+template <typename Fn>
+void DiffTextView::forEachDocumentRow(int first, int last, Fn&& fn) const
+{
+    using bendiff::core::render::RenderBlockSide;
+
+    if (!m_doc || first >= last) {
+        return;
+    }
+
+    // Lazy documents (no blocks): fetch each row from the aligned rows.
+    if (m_doc->blocks.empty()) {
+        for (int row = first; row < last && row < m_rowCount; ++row) {
+            const auto line = bendiff::core::render::RenderRowAt(*m_doc, static_cast<std::size_t>(row));
+            const bool useRight = m_mode == Mode::SideBySideRight ||
+                                  (m_mode == Mode::Inline && line.op == bendiff::core::diff::LineOp::Insert);
+            RowView v;
+            v.op = line.op;
+            v.lineNumber = useRight ? line.rightLine : line.leftLine;
+            v.text = useRight ? line.rightText : line.leftText;
+            fn(row, v);
+        }
+        return;
+    }
+
+    if (m_blockStarts.empty()) {
+        return;
+    }
+
+    // Last block starting at or before `first`.
+    const auto it = std::upper_bound(m_blockStarts.begin(), m_blockStarts.end(), first);
+    auto b = static_cast<std::size_t>(std::distance(m_blockStarts.begin(), it)) - 1;
+
+    int row = first;
+    for (; b < m_doc->blocks.size() && row < last; ++b) {
+        const auto& block = m_doc->blocks[b];
+
+        // Inline policy (v1): show only one side at a time.
+        // - For Right blocks (inserts), display right line numbers/text.
+        // - For Left blocks (deletes) and neutral Both blocks (equal lines), display left line numbers/text.
+        const bool useRight = m_mode == Mode::SideBySideRight ||
+                              (m_mode == Mode::Inline && block.side == RenderBlockSide::Right);
+
+        for (auto i = static_cast<std::size_t>(row - m_blockStarts[b]); i < block.lines.size() && row < last; ++i) {
+            const auto& line = block.lines[i];
+            RowView v;
+            v.op = line.op;
+            v.lineNumber = useRight ? line.rightLine : line.leftLine;
+            v.text = useRight ? line.rightText : line.leftText;
+            fn(row, v);
+            ++row;
+        }
+    }
+}
+
+void DiffTextView::resetContent()
+{
+    m_doc.reset();
+    m_messageLines.clear();
+    m_blockStarts.clear();
+    m_rowCount = 0;
+    m_lineNumberWidth = 1;
+    m_maxTextColumns = 0;
+    m_selectionAnchor.reset();
+    m_selectionCursor.reset();
 }
 
 void DiffTextView::setMessage(const QString& message)
 {
-    setExtraSelections({});
-    setPlainText(message);
-    moveCursor(QTextCursor::Start);
+    resetContent();
+
+    m_messageLines = message.split(QLatin1Char('\n'));
+    m_rowCount = static_cast<int>(m_messageLines.size());
+    for (const auto& line : m_messageLines) {
+        const QByteArray utf8 = line.toUtf8();
+        const auto columns = bendiff::core::render::DisplayColumns(std::string_view(utf8.constData(), utf8.size()));
+        m_maxTextColumns = std::max(m_maxTextColumns, static_cast<int>(columns));
+    }
+
+    updateMetrics();
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    viewport()->update();
+}
+
+void DiffTextView::setRenderDocument(std::shared_ptr<const bendiff::core::render::RenderDocument> doc, Mode mode)
+{
+    resetContent();
+    if (!doc) {
+        updateMetrics();
+        viewport()->update();
+        return;
+    }
+
+    m_doc = std::move(doc);
+    m_mode = mode;
+
+    // The horizontal scroll range covers the widest row as drawn, with tabs
+    // expanded to their tab stops; the builders measured each side's widest
+    // line on the worker.
+    if (mode != Mode::SideBySideRight) {
+        m_maxTextColumns = std::max(m_maxTextColumns, static_cast<int>(m_doc->leftColumns));
+    }
+    if (mode != Mode::SideBySideLeft) {
+        m_maxTextColumns = std::max(m_maxTextColumns, static_cast<int>(m_doc->rightColumns));
+    }
+
+    if (m_doc->blocks.empty()) {
+        // Lazy document: the rows are built only as they are painted.
+        m_rowCount = static_cast<int>(m_doc->rows.rowCount());
+    } else {
+        m_blockStarts.reserve(m_doc->blocks.size());
+        int row = 0;
+        for (const auto& block : m_doc->blocks) {
+            m_blockStarts.push_back(row);
+            row += static_cast<int>(block.lines.size());
+        }
+        m_rowCount = row;
+    }
+    m_lineNumberWidth = computeLineNumberWidth(*m_doc, mode);
+
+    updateMetrics();
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    viewport()->update();
+}
+
+int DiffTextView::rowCount() const
+{
+    return m_rowCount;
+}
+
+void DiffTextView::scrollToRow(int row)
+{
+    verticalScrollBar()->setValue(std::max(0, row - visibleRowCount() / 2));
+}
+
+int DiffTextView::firstVisibleRow() const
+{
+    return verticalScrollBar()->value();
+}
+
+int DiffTextView::visibleRowCount() const
+{
+    return std::max(1, viewport()->height() / rowHeight());
+}
+
+int DiffTextView::rowHeight() const
+{
+    return std::max(1, fontMetrics().height());
+}
+
+int DiffTextView::rowAt(int y) const
+{
+    const int row = verticalScrollBar()->value() + std::max(0, y) / rowHeight();
+    return std::clamp(row, 0, std::max(0, m_rowCount - 1));
+}
+
+void DiffTextView::updateMetrics()
+{
+    const int charWidth = fontMetrics().horizontalAdvance(QLatin1Char('0'));
+    m_gutterWidth = m_doc ? (m_lineNumberWidth * charWidth + 2 * kTextMargin) : 0;
+    updateScrollBars();
+    viewport()->update();
+}
+
+void DiffTextView::updateScrollBars()
+{
+    const int visibleRows = std::max(1, viewport()->height() / rowHeight());
+    verticalScrollBar()->setSingleStep(1);
+    verticalScrollBar()->setPageStep(visibleRows);
+    verticalScrollBar()->setRange(0, std::max(0, m_rowCount - visibleRows));
+
+    const int charWidth = fontMetrics().horizontalAdvance(QLatin1Char('0'));
+    const int contentWidth = m_gutterWidth + kTextMargin + m_maxTextColumns * charWidth;
+    horizontalScrollBar()->setSingleStep(charWidth);
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setRange(0, std::max(0, contentWidth - viewport()->width()));
+}
+
+void DiffTextView::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(viewport());
+    painter.fillRect(event->rect(), palette().base());
+
+    if (m_rowCount == 0) {
+        return;
+    }
+
+    const int height = rowHeight();
+    const int width = viewport()->width();
+    const int first = verticalScrollBar()->value();
+    const int last = std::min(m_rowCount, first + viewport()->height() / height + 2);
+    const int textX = m_gutterWidth + kTextMargin - horizontalScrollBar()->value();
+
+    int selFirst = -1;
+    int selLast = -1;
+    if (m_selectionAnchor && m_selectionCursor) {
+        selFirst = std::min(*m_selectionAnchor, *m_selectionCursor);
+        selLast = std::max(*m_selectionAnchor, *m_selectionCursor);
+    }
+    QColor selectionColor = palette().highlight().color();
+    selectionColor.setAlpha(80);
+
+    const auto rowsRect = [&](int from, int to, int x, int w) {
+        return QRect(x, (from - first) * height, w, (to - from) * height);
+    };
+
+    // Change backgrounds: one rect per visible run of changed rows.
+    const auto paintChangeRuns = [&](int x, int w) {
+        for (const auto& run : visibleChangeRuns(first, last)) {
+            if (!shouldColorLine(run.op, m_mode)) {
+                continue;
+            }
+            const int from = std::max(first, static_cast<int>(run.firstRow));
+            const int to = std::min(last, static_cast<int>(run.firstRow + run.rowCount));
+            painter.fillRect(rowsRect(from, to, x, w), backgroundForOp(run.op));
+        }
+    };
+
+    paintChangeRuns(0, width);
+    if (selFirst >= 0) {
+        const int from = std::max(first, selFirst);
+        const int to = std::min(last, selLast + 1);
+        if (from < to) {
+            painter.fillRect(rowsRect(from, to, 0, width), selectionColor);
+        }
+    }
+
+    // Tabs stop every kTabStopColumns character widths, matching the
+    // DisplayColumns() the scroll range was sized with.
+    QTextOption textOption(Qt::AlignLeft | Qt::AlignVCenter);
+    textOption.setWrapMode(QTextOption::NoWrap);
+    textOption.setTabStopDistance(static_cast<qreal>(bendiff::core::render::kTabStopColumns)
+                                  * fontMetrics().horizontalAdvance(QLatin1Char('0')));
+
+    painter.setPen(palette().text().color());
+    const auto paintText = [&](int row, const QString& text) {
+        painter.drawText(QRectF(rowsRect(row, row + 1, textX, kMaxRowPixels)), text, textOption);
+    };
+
+    if (!m_doc) {
+        for (int row = first; row < last; ++row) {
+            paintText(row, m_messageLines[row]);
+        }
+        return;
+    }
+
+    forEachDocumentRow(first, last, [&](int row, const RowView& v) {
+        paintText(row, QString::fromUtf8(v.text));
+    });
+
+    // The gutter stays put while the text scrolls horizontally under it.
+    painter.fillRect(QRect(0, 0, m_gutterWidth, viewport()->height()), palette().alternateBase());
+    paintChangeRuns(0, m_gutterWidth);
+
+    painter.setPen(palette().placeholderText().color());
+    forEachDocumentRow(first, last, [&](int row, const RowView& v) {
+        painter.drawText(rowsRect(row, row + 1, kTextMargin, m_gutterWidth - 2 * kTextMargin),
+                         Qt::AlignRight | Qt::AlignVCenter,
+                         formatLineNumber(v.lineNumber, m_lineNumberWidth));
+    });
+
+    painter.setPen(palette().mid().color());
+    painter.drawLine(m_gutterWidth - 1, 0, m_gutterWidth - 1, viewport()->height());
+}
+
+std::span<const bendiff::core::render::RenderRowRun> DiffTextView::visibleChangeRuns(int first, int last) const
+{
+    if (!m_doc) {
+        return {};
+    }
+
+    const auto& runs = m_doc->changeRuns;
+    const auto begin = std::partition_point(runs.begin(), runs.end(), [first](const auto& run) {
+        return run.firstRow + run.rowCount <= static_cast<std::size_t>(first);
+    });
+    const auto end = std::partition_point(begin, runs.end(), [last](const auto& run) {
+        return run.firstRow < static_cast<std::size_t>(last);
+    });
+    return {begin, end};
+}
+
+void DiffTextView::resizeEvent(QResizeEvent* event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void DiffTextView::changeEvent(QEvent* event)
+{
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        updateMetrics();
+    }
+}
+
+void DiffTextView::keyPressEvent(QKeyEvent* event)
+{
+    if (event->matches(QKeySequence::Copy)) {
+        copySelection();
+        return;
+    }
+    if (event->matches(QKeySequence::SelectAll)) {
+        if (m_rowCount > 0) {
+            m_selectionAnchor = 0;
+            m_selectionCursor = m_rowCount - 1;
+            viewport()->update();
+        }
+        return;
+    }
+    if (event->matches(QKeySequence::MoveToStartOfDocument)) {
+        verticalScrollBar()->setValue(0);
+        return;
+    }
+    if (event->matches(QKeySequence::MoveToEndOfDocument)) {
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+        return;
+    }
+    QAbstractScrollArea::keyPressEvent(event);
+}
+
+void DiffTextView::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() != Qt::LeftButton || m_rowCount == 0) {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
+
+    const int row = rowAt(event->position().toPoint().y());
+    if (!(event->modifiers() & Qt::ShiftModifier) || !m_selectionAnchor) {
+        m_selectionAnchor = row;
+    }
+    m_selectionCursor = row;
+    viewport()->update();
+}
+
+void DiffTextView::mouseMoveEvent(QMouseEvent* event)
+{
+    if (!(event->buttons() & Qt::LeftButton) || !m_selectionAnchor) {
+        QAbstractScrollArea::mouseMoveEvent(event);
+        return;
+    }
+
+    m_selectionCursor = rowAt(event->position().toPoint().y());
+    viewport()->update();
+}
+
+void DiffTextView::copySelection() const
+{
+    if (!m_selectionAnchor || !m_selectionCursor) {
+        return;
+    }
+    const int first = std::min(*m_selectionAnchor, *m_selectionCursor);
+    const int last = std::max(*m_selectionAnchor, *m_selectionCursor) + 1;
+
+    QStringList lines;
+    lines.reserve(last - first);
+    if (m_doc) {
+        forEachDocumentRow(first, last, [&](int, const RowView& v) {
+            lines.push_back(QString::fromUtf8(v.text));
+        });
+    } else {
+        for (int row = first; row < last && row < m_rowCount; ++row) {
+            lines.push_back(m_messageLines[row]);
+        }
+    }
+
+    QGuiApplication::clipboard()->setText(lines.join(QLatin1Char('\n')));
 }
 
 QString DiffTextView::formatLineNumber(std::optional<std::size_t> oneBasedLine, int width)
@@ -33,6 +416,17 @@ int DiffTextView::computeLineNumberWidth(const bendiff::core::render::RenderDocu
 {
     std::size_t maxLine = 0;
 
+    // Lazy documents: line numbers run up to the line count of the side(s)
+    // shown.
+    if (doc.blocks.empty()) {
+        if (mode != Mode::SideBySideRight) {
+            maxLine = std::max(maxLine, doc.leftLines.size());
+        }
+        if (mode != Mode::SideBySideLeft) {
+            maxLine = std::max(maxLine, doc.rightLines.size());
+        }
+    }
+
     for (const auto& block : doc.blocks) {
         for (const auto& line : block.lines) {
             switch (mode) {
@@ -102,76 +496,3 @@ QColor DiffTextView::backgroundForOp(bendiff::core::diff::LineOp op)
     }
     return QColor();
 }
-
-void DiffTextView::applyExtraSelections(const bendiff::core::render::RenderDocument& doc, Mode mode)
-{
-    using bendiff::core::diff::LineOp;
-
-    QList<QTextEdit::ExtraSelection> sels;
-
-    int visualRow = 0;
-    for (const auto& block : doc.blocks) {
-        for (const auto& line : block.lines) {
-            if (shouldColorLine(line.op, mode)) {
-                QTextCursor c(document()->findBlockByNumber(visualRow));
-                c.select(QTextCursor::LineUnderCursor);
-
-                QTextEdit::ExtraSelection sel;
-                sel.cursor = c;
-                sel.format.setBackground(backgroundForOp(line.op));
-                sels.push_back(sel);
-            }
-            ++visualRow;
-        }
-    }
-
-    setExtraSelections(sels);
-}
-
-void DiffTextView::setRenderDocument(const bendiff::core::render::RenderDocument& doc, Mode mode)
-{
-    const int width = computeLineNumberWidth(doc, mode);
-
-    QString text;
-    text.reserve(1024);
-
-    for (const auto& block : doc.blocks) {
-        for (const auto& line : block.lines) {
-            QString lineNum;
-            QString content;
-
-            switch (mode) {
-                case Mode::SideBySideLeft:
-                    lineNum = formatLineNumber(line.leftLine, width);
-                    content = QString::fromStdString(line.leftText);
-                    break;
-                case Mode::SideBySideRight:
-                    lineNum = formatLineNumber(line.rightLine, width);
-                    content = QString::fromStdString(line.rightText);
-                    break;
-                case Mode::Inline:
-                    // Inline policy (v1): show only one side at a time.
-                    // - For Right blocks (inserts), display right line numbers/text.
-                    // - For Left blocks (deletes) and neutral Both blocks (equal lines), display left line numbers/text.
-                    if (block.side == bendiff::core::render::RenderBlockSide::Right) {
-                        lineNum = formatLineNumber(line.rightLine, width);
-                        content = QString::fromStdString(line.rightText);
-                    } else {
-                        lineNum = formatLineNumber(line.leftLine, width);
-                        content = QString::fromStdString(line.leftText);
-                    }
-                    break;
-            }
-
-            text += lineNum;
-            text += " | ";
-            text += content;
-            text += "\n";
-        }
-    }
-
-    setPlainText(text);
-    moveCursor(QTextCursor::Start);
-
-    applyExtraSelections(doc, mode);
-}
@@ -1,12 +1,26 @@
 #pragma once
 
-#include <QPlainTextEdit>
+#include <QAbstractScrollArea>
+#include <QStringList>
 
 #include <render/diff_render_model.h>
 
+#include <cstddef>
+#include <memory>
 #include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
 
-class DiffTextView final : public QPlainTextEdit
+// Read-only diff pane.
+//
+// Rows are painted straight from the RenderDocument on demand: every row has
+// the same height (monospace font, no wrapping), so the vertical scroll bar
+// counts rows and a paint only touches the rows in the viewport. Nothing is
+// laid out up front, which keeps very large diffs cheap to show. Lazy
+// documents (BuildLazyRender) go further: they have no blocks, and each
+// painted row is built from the aligned rows as it is needed.
+class DiffTextView final : public QAbstractScrollArea
 {
     Q_OBJECT
 
@@ -19,15 +33,73 @@ public:
 
     explicit DiffTextView(QWidget* parent = nullptr);
 
+    // Shows plain text (one row per line, no gutter).
     void setMessage(const QString& message);
 
-    void setRenderDocument(const bendiff::core::render::RenderDocument& doc, Mode mode);
+    // Shows `doc` as seen from `mode`. The view keeps a reference to `doc`.
+    void setRenderDocument(std::shared_ptr<const bendiff::core::render::RenderDocument> doc, Mode mode);
+
+    int rowCount() const;
+
+    // Scrolls so that `row` is vertically centered (as far as possible).
+    void scrollToRow(int row);
+
+    // The rows in view: [firstVisibleRow(), firstVisibleRow() + visibleRowCount()).
+    int firstVisibleRow() const;
+    int visibleRowCount() const;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void changeEvent(QEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
 
 private:
-    void applyExtraSelections(const bendiff::core::render::RenderDocument& doc, Mode mode);
+    // What to draw for one row.
+    struct RowView {
+        std::optional<std::size_t> lineNumber;
+        std::string_view text;
+        bendiff::core::diff::LineOp op = bendiff::core::diff::LineOp::Equal;
+    };
+
+    // Calls `fn(row, RowView)` for rows [first, last) of the document.
+    template <typename Fn>
+    void forEachDocumentRow(int first, int last, Fn&& fn) const;
+
+    void resetContent();
+    void updateMetrics();
+    void updateScrollBars();
+    int rowHeight() const;
+    int rowAt(int y) const;
+
+    // Change runs (RenderDocument::changeRuns) overlapping rows [first, last),
+    // found by binary search.
+    std::span<const bendiff::core::render::RenderRowRun> visibleChangeRuns(int first, int last) const;
+    void copySelection() const;
 
     static QString formatLineNumber(std::optional<std::size_t> oneBasedLine, int width);
     static int computeLineNumberWidth(const bendiff::core::render::RenderDocument& doc, Mode mode);
     static bool shouldColorLine(bendiff::core::diff::LineOp op, Mode mode);
     static QColor backgroundForOp(bendiff::core::diff::LineOp op);
+
+    Mode m_mode = Mode::Inline;
+
+    // Exactly one of these is shown: a document, or message lines.
+    std::shared_ptr<const bendiff::core::render::RenderDocument> m_doc;
+    QStringList m_messageLines;
+
+    // m_blockStarts[i] is the first row of m_doc->blocks[i]; used to find the
+    // block holding a row by binary search.
+    std::vector<int> m_blockStarts;
+    int m_rowCount = 0;
+
+    int m_lineNumberWidth = 1; // digits
+    int m_gutterWidth = 0;     // pixels (0 in message mode)
+    int m_maxTextColumns = 0;
+
+    // Selected rows [anchor, cursor] (inclusive, either order), for copying.
+    std::optional<int> m_selectionAnchor;
+    std::optional<int> m_selectionCursor;
 };
@@ -0,0 +1,466 @@
+#include "content_hash_cache.h"
+
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace bendiff::core {
+
+namespace {
+
+constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ull;
+constexpr std::uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+
+std::uint64_t Load64(const char* p)
+{
+    std::uint64_t w = 0;
+    std::memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+std::uint64_t Round(std::uint64_t acc, std::uint64_t input)
+{
+    acc += input * kPrime2;
+    acc = std::rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+std::uint64_t Avalanche(std::uint64_t h)
+{
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+constexpr std::size_t kHashChunk = 256 * 1024;
+
+// Records whose files have been modified this recently are not kept (see
+// ContentHashCache).
+constexpr std::int64_t kRacyWindowNs = 2'000'000'000;
+
+// Records no compare has used for this many days are dropped on Load().
+constexpr std::int64_t kMaxIdleDays = 30;
+
+// Past this many records (some 30 MB of cache file), Save() keeps the most
+// recently used.
+constexpr std::size_t kMaxRecords = std::size_t{1} << 18;
+
+// "BDHC", format version, and a byte-order mark: the records are written in
+// native byte order, so a file from a machine of the other endianness reads
+// as foreign rather than as garbage.
+constexpr char kMagic[4] = {'B', 'D', 'H', 'C'};
+constexpr std::uint32_t kVersion = 2;
+constexpr std::uint32_t kByteOrderMark = 0x01020304;
+
+struct RecordHeader {
+    std::uint64_t size;
+    std::int64_t mtimeNs;
+    std::uint64_t device;
+    std::uint64_t inode;
+    std::uint64_t hashLow;
+    std::uint64_t hashHigh;
+    std::int64_t lastUsedDay;
+    std::uint64_t pathLength;
+};
+
+// Now, on the clock FileMetadata::mtimeNs counts from.
+std::int64_t NowNs()
+{
+#if defined(_WIN32)
+    const auto now = fs::file_time_type::clock::now().time_since_epoch();
+#else
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+#endif
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+std::int64_t Today()
+{
+    return NowNs() / (std::int64_t{86'400} * 1'000'000'000);
+}
+
+// The directory part of a record's path.
+std::string_view ParentOf(std::string_view path)
+{
+#if defined(_WIN32)
+    const auto slash = path.find_last_of("/\\");
+#else
+    const auto slash = path.find_last_of('/');
+#endif
+    return slash == std::string_view::npos ? std::string_view() : path.substr(0, slash);
+}
+
+bool SameMetadata(const FileMetadata& a, const FileMetadata& b)
+{
+    return a.size == b.size && a.mtimeNs == b.mtimeNs && a.device == b.device && a.inode == b.inode;
+}
+
+std::optional<fs::path> env_path(const char* name)
+{
+    if (const char* value = std::getenv(name)) {
+        if (*value != '\0') {
+            return fs::path(value);
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename T>
+void Put(std::string& out, const T& value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool Take(std::string_view& in, T& value)
+{
+    if (in.size() < sizeof(value)) {
+        return false;
+    }
+    std::memcpy(&value, in.data(), sizeof(value));
+    in.remove_prefix(sizeof(value));
+    return true;
+}
+
+} // namespace
+
+// Four independent lanes over 32-byte stripes, so the multiplies of
+// neighbouring words overlap; the tail is zero-padded into one more stripe
+// and the length mixed in to tell it from real zeros.
+ContentHasher::ContentHasher()
+    : m_lanes{kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1}
+{
+}
+
+void ContentHasher::Update(std::string_view bytes)
+{
+    m_length += bytes.size();
+
+    if (m_pending > 0) {
+        const std::size_t take = std::min(bytes.size(), sizeof(m_stripe) - m_pending);
+        std::memcpy(m_stripe + m_pending, bytes.data(), take);
+        m_pending += take;
+        bytes.remove_prefix(take);
+        if (m_pending < sizeof(m_stripe)) {
+            return;
+        }
+        for (int k = 0; k < 4; ++k) {
+            m_lanes[k] = Round(m_lanes[k], Load64(m_stripe + 8 * k));
+        }
+        m_pending = 0;
+    }
+
+    const char* p = bytes.data();
+    std::size_t i = 0;
+    for (; i + 32 <= bytes.size(); i += 32) {
+        for (int k = 0; k < 4; ++k) {
+            m_lanes[k] = Round(m_lanes[k], Load64(p + i + 8 * k));
+        }
+    }
+    m_pending = bytes.size() - i;
+    std::memcpy(m_stripe, p + i, m_pending);
+}
+
+ContentHash ContentHasher::Finish() const
+{
+    std::uint64_t v[4] = {m_lanes[0], m_lanes[1], m_lanes[2], m_lanes[3]};
+    if (m_pending > 0) {
+        char tail[32] = {};
+        std::memcpy(tail, m_stripe, m_pending);
+        for (int k = 0; k < 4; ++k) {
+            v[k] = Round(v[k], Load64(tail + 8 * k));
+        }
+    }
+
+    return ContentHash{
+        .low = Avalanche(std::rotl(v[0], 1) + std::rotl(v[1], 7) + std::rotl(v[2], 12) + std::rotl(v[3], 18)
+                         + m_length * kPrime4),
+        .high = Avalanche((v[0] * kPrime3) ^ std::rotl(v[1], 29) ^ (v[2] * kPrime4) ^ std::rotl(v[3], 41)
+                          ^ (m_length * kPrime1)),
+    };
+}
+
+ContentHash HashBytes(std::string_view bytes)
+{
+    ContentHasher hasher;
+    hasher.Update(bytes);
+    return hasher.Finish();
+}
+
+std::optional<ContentHash> HashFile(const fs::path& path)
+{
+    SequentialFile file;
+    if (file.Open(path) != FileReadStatus::Ok) {
+        return std::nullopt;
+    }
+
+    ContentHasher hasher;
+    std::vector<char> chunk(kHashChunk);
+    while (true) {
+        const auto n = file.Read(chunk);
+        if (!n) {
+            return std::nullopt;
+        }
+        hasher.Update(std::string_view(chunk.data(), *n));
+        if (*n < chunk.size()) {
+            return hasher.Finish();
+        }
+    }
+}
+
+ContentHashCache::ContentHashCache(fs::path file)
+    : m_file(std::move(file))
+    , m_today(Today())
+{
+}
+
+fs::path ContentHashCache::DefaultFile()
+{
+#if defined(_WIN32)
+    if (auto base = env_path("LOCALAPPDATA")) {
+        return *base / "BenDiff" / "cache" / "content-hashes";
+    }
+    return fs::temp_directory_path() / "BenDiff" / "cache" / "content-hashes";
+#else
+    if (auto base = env_path("XDG_CACHE_HOME")) {
+        return *base / "bendiff" / "content-hashes";
+    }
+    if (auto home = env_path("HOME")) {
+        return *home / ".cache" / "bendiff" / "content-hashes";
+    }
+    return fs::temp_directory_path() / "bendiff" / "content-hashes";
+#endif
+}
+
+bool ContentHashCache::Load()
+{
+    std::unordered_map<std::string, Record> records;
+    bool dropped = false;
+    const auto commit = [&] {
+        std::lock_guard lock(m_mutex);
+        m_records = std::move(records);
+        m_dirty = dropped;
+    };
+
+    SequentialFile file;
+    const auto bytes = file.Open(m_file) == FileReadStatus::Ok ? file.ReadAll() : std::nullopt;
+    if (!bytes) {
+        commit();
+        return false;
+    }
+
+    std::string_view in = *bytes;
+    char magic[4] = {};
+    std::uint32_t version = 0;
+    std::uint32_t byteOrder = 0;
+    std::uint64_t count = 0;
+    if (!Take(in, magic) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || !Take(in, version)
+        || version != kVersion || !Take(in, byteOrder) || byteOrder != kByteOrderMark || !Take(in, count)) {
+        commit();
+        return false;
+    }
+
+    records.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(count, kMaxRecords)));
+    for (std::uint64_t r = 0; r < count; ++r) {
+        RecordHeader h{};
+        if (!Take(in, h) || in.size() < h.pathLength) {
+            records.clear();
+            commit();
+            return false;
+        }
+        records[std::string(in.substr(0, static_cast<std::size_t>(h.pathLength)))] = Record{
+            .metadata = FileMetadata{
+                .size = h.size,
+                .mtimeNs = h.mtimeNs,
+                .device = h.device,
+                .inode = h.inode,
+                .valid = true,
+            },
+            .hash = ContentHash{.low = h.hashLow, .high = h.hashHigh},
+            .lastUsedDay = h.lastUsedDay,
+            .usedInPass = 0,
+        };
+        in.remove_prefix(static_cast<std::size_t>(h.pathLength));
+    }
+
+    // Drop records no compare has wanted for a while, and those whose
+    // directory is gone: trees that were deleted, such as the temporary
+    // copies of an earlier `git difftool --dir-diff`, are never compared (and
+    // so never pruned) again. Each directory is checked once.
+    const std::int64_t today = Today();
+    std::unordered_map<std::string, bool> dirExists;
+    dropped = std::erase_if(records, [&](const auto& entry) {
+        if (today - entry.second.lastUsedDay > kMaxIdleDays) {
+            return true;
+        }
+        const auto [it, inserted] = dirExists.try_emplace(std::string(ParentOf(entry.first)));
+        if (inserted) {
+            std::error_code ec;
+            it->second = fs::is_directory(fs::path(it->first), ec);
+        }
+        return !it->second;
+    }) > 0;
+
+    commit();
+    return true;
+}
+
+bool ContentHashCache::Save()
+{
+    std::string out;
+    {
+        std::lock_guard lock(m_mutex);
+        if (!m_dirty) {
+            return true;
+        }
+        m_dirty = false;
+
+        // Over the cap, keep the most recently used records.
+        std::vector<const std::pair<const std::string, Record>*> kept;
+        kept.reserve(m_records.size());
+        for (const auto& entry : m_records) {
+            kept.push_back(&entry);
+        }
+        if (kept.size() > kMaxRecords) {
+            std::nth_element(kept.begin(), kept.begin() + kMaxRecords, kept.end(), [](const auto* a, const auto* b) {
+                return a->second.lastUsedDay > b->second.lastUsedDay;
+            });
+            kept.resize(kMaxRecords);
+        }
+
+        std::size_t bytes = 0;
+        for (const auto* entry : kept) {
+            bytes += sizeof(RecordHeader) + entry->first.size();
+        }
+
+        const std::uint64_t count = kept.size();
+        out.reserve(sizeof(kMagic) + 2 * sizeof(std::uint32_t) + sizeof(count) + bytes);
+        out.append(kMagic, sizeof(kMagic));
+        Put(out, kVersion);
+        Put(out, kByteOrderMark);
+        Put(out, count);
+        for (const auto* entry : kept) {
+            const auto& [path, record] = *entry;
+            Put(out, RecordHeader{
+                         .size = record.metadata.size,
+                         .mtimeNs = record.metadata.mtimeNs,
+                         .device = record.metadata.device,
+                         .inode = record.metadata.inode,
+                         .hashLow = record.hash.low,
+                         .hashHigh = record.hash.high,
+                         .lastUsedDay = record.lastUsedDay,
+                         .pathLength = path.size(),
+                     });
+            out.append(path);
+        }
+    }
+
+    std::error_code ec;
+    fs::create_directories(m_file.parent_path(), ec);
+
+    // A per-writer temporary, so two instances saving at once can't
+    // interleave; the last rename wins.
+    const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    fs::path tmp = m_file;
+    tmp += ".tmp" + std::to_string(stamp);
+    const auto failed = [&] {
+        fs::remove(tmp, ec);
+        std::lock_guard lock(m_mutex);
+        m_dirty = true;
+        return false;
+    };
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+            file.close();
+            return failed();
+        }
+    }
+    fs::rename(tmp, m_file, ec);
+    if (ec) {
+        return failed();
+    }
+    return true;
+}
+
+void ContentHashCache::BeginPass()
+{
+    std::lock_guard lock(m_mutex);
+    ++m_pass;
+    m_today = Today();
+}
+
+std::size_t ContentHashCache::PruneUnder(const fs::path& root)
+{
+    const std::string prefix = (root / "").string();
+    std::lock_guard lock(m_mutex);
+    const auto dropped = std::erase_if(m_records, [&](const auto& entry) {
+        return entry.second.usedInPass != m_pass && entry.first.starts_with(prefix);
+    });
+    m_dirty = m_dirty || dropped > 0;
+    return dropped;
+}
+
+std::optional<ContentHash> ContentHashCache::Lookup(const fs::path& path, const FileMetadata& metadata)
+{
+    if (!metadata.valid) {
+        return std::nullopt;
+    }
+    std::lock_guard lock(m_mutex);
+    const auto it = m_records.find(path.string());
+    if (it == m_records.end() || !SameMetadata(it->second.metadata, metadata)) {
+        return std::nullopt;
+    }
+    MarkUsed(it->second);
+    return it->second.hash;
+}
+
+void ContentHashCache::Store(const fs::path& path, const FileMetadata& metadata, const ContentHash& hash)
+{
+    if (!metadata.valid || metadata.mtimeNs > NowNs() - kRacyWindowNs) {
+        return;
+    }
+    std::lock_guard lock(m_mutex);
+    auto [it, inserted] = m_records.try_emplace(path.string());
+    auto& record = it->second;
+    if (inserted || !SameMetadata(record.metadata, metadata) || record.hash != hash) {
+        record.metadata = metadata;
+        record.hash = hash;
+        m_dirty = true;
+    }
+    MarkUsed(record);
+}
+
+void ContentHashCache::MarkUsed(Record& record)
+{
+    record.usedInPass = m_pass;
+    // The day a record was last used is saved with it; bumping it makes the
+    // next Save() write, but at most once a day.
+    if (record.lastUsedDay != m_today) {
+        record.lastUsedDay = m_today;
+        m_dirty = true;
+    }
+}
+
+std::size_t ContentHashCache::size() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_records.size();
+}
+
+} // namespace bendiff::core
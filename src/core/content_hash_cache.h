@@ -0,0 +1,124 @@
+#pragma once
+
+#include <dir_walk.h>
+
+#include <compare>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace bendiff::core {
+
+// 128-bit content hash. Not cryptographic: it tells unchanged content from
+// changed content, not content from an adversary.
+struct ContentHash {
+    std::uint64_t low = 0;
+    std::uint64_t high = 0;
+
+    friend bool operator==(const ContentHash&, const ContentHash&) = default;
+};
+
+// Incremental HashBytes(): feeding the same bytes in any split gives the
+// same hash.
+class ContentHasher {
+public:
+    ContentHasher();
+
+    void Update(std::string_view bytes);
+    ContentHash Finish() const;
+
+private:
+    std::uint64_t m_lanes[4];
+    char m_stripe[32] = {};
+    std::size_t m_pending = 0; // bytes buffered in m_stripe
+    std::uint64_t m_length = 0;
+};
+
+ContentHash HashBytes(std::string_view bytes);
+
+// Hash of a whole file's bytes, read front to back (see SequentialFile), or
+// nullopt if it can't be read.
+std::optional<ContentHash> HashFile(const std::filesystem::path& path);
+
+// Content hashes of files, remembered across runs in one cache file.
+//
+// A hash is keyed by the file's absolute path and is only returned while the
+// file's device, inode, size and mtime still match what was recorded, so a
+// refresh of a mostly unchanged tree hashes just the files that changed.
+// Files modified within the last couple of seconds are not recorded: their
+// mtime may not move on a further write within the filesystem's timestamp
+// granularity.
+//
+// A compare pass brackets its lookups with BeginPass() and PruneUnder(root),
+// which drops the records under the compared roots that the pass no longer
+// needed (deleted, renamed or now one-sided files), so the file tracks the
+// trees instead of growing. Records of trees that are no longer compared are
+// dropped by Load() once their directory is gone or they have gone unused
+// for a month, and Save() keeps at most a few hundred thousand, most
+// recently used first. Save() only writes when something changed.
+//
+// Load() and Save() read and write the whole file; call them off the GUI
+// thread.
+//
+// Thread-safe: the folder compare looks up and stores from worker threads.
+class ContentHashCache {
+public:
+    // An empty cache that loads from and saves to `file`.
+    explicit ContentHashCache(std::filesystem::path file);
+
+    // $XDG_CACHE_HOME/bendiff/content-hashes (or the platform equivalent).
+    static std::filesystem::path DefaultFile();
+
+    const std::filesystem::path& file() const { return m_file; }
+
+    // Replaces the contents with the cache file's, less stale records (see
+    // above). A missing, truncated or foreign file leaves the cache empty and
+    // returns false.
+    bool Load();
+
+    // Writes the cache file (atomically, via a temporary and a rename) if any
+    // record was added, changed or dropped since the last Load() or Save();
+    // otherwise does nothing. Returns false only if a write failed.
+    bool Save();
+
+    // Starts a compare pass: records looked up or stored from now on are the
+    // ones PruneUnder() keeps.
+    void BeginPass();
+
+    // Drops records for paths under `root` that were not used since
+    // BeginPass(). Returns how many were dropped.
+    std::size_t PruneUnder(const std::filesystem::path& root);
+
+    // The recorded hash of `path`, if `metadata` still matches the record.
+    std::optional<ContentHash> Lookup(const std::filesystem::path& path, const FileMetadata& metadata);
+
+    // Records `hash` for `path` as it is described by `metadata` (unless the
+    // file is too freshly modified to be trusted).
+    void Store(const std::filesystem::path& path, const FileMetadata& metadata, const ContentHash& hash);
+
+    std::size_t size() const;
+
+private:
+    struct Record {
+        FileMetadata metadata;
+        ContentHash hash;
+        std::int64_t lastUsedDay = 0; // days since the epoch
+        std::uint64_t usedInPass = 0; // 0: not used since Load()
+    };
+
+    // Notes a lookup or store of `record` (m_mutex held).
+    void MarkUsed(Record& record);
+
+    std::filesystem::path m_file;
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Record> m_records;
+    std::uint64_t m_pass = 1;
+    std::int64_t m_today = 0;
+    bool m_dirty = false;
+};
+
+} // namespace bendiff::core
@@ -1,82 +1,48 @@
 #include <diff/alignment.h>
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
 
 namespace bendiff::core::diff {
 
-namespace {
-
-inline void apply_op_positions(LineOp op, std::size_t& leftPos, std::size_t& rightPos)
+std::vector<AlignedRun> BuildAlignedRuns(const DiffResult& r)
 {
-    switch (op) {
-    case LineOp::Equal:
-        ++leftPos;
-        ++rightPos;
-        return;
-    case LineOp::Delete:
-        ++leftPos;
-        return;
-    case LineOp::Insert:
-        ++rightPos;
-        return;
-    }
-}
-
-} // namespace
-
-std::vector<AlignedRow> BuildAlignedRows(const DiffResult& r)
-{
-    std::vector<AlignedRow> rows;
-    rows.reserve(r.leftLineCount + r.rightLineCount);
+    std::vector<AlignedRun> runs;
 
     std::size_t leftPos = 0;
     std::size_t rightPos = 0;
 
-    auto emit_equals = [&](std::size_t count) {
-        for (std::size_t i = 0; i < count; ++i) {
-            rows.push_back(AlignedRow{
-                .left = leftPos,
-                .right = rightPos,
-                .op = LineOp::Equal,
-            });
-            ++leftPos;
-            ++rightPos;
+    auto emit = [&](LineOp op, std::size_t length) {
+        if (length == 0) {
+            return;
+        }
+        runs.push_back(AlignedRun{
+            .op = op,
+            .leftStart = leftPos,
+            .rightStart = rightPos,
+            .length = length,
+        });
+        if (op != LineOp::Insert) {
+            leftPos += length;
+        }
+        if (op != LineOp::Delete) {
+            rightPos += length;
         }
     };
 
     for (const auto& h : r.hunks) {
-        // Emit equal run before the hunk (if any).
+        // Equal run before the hunk (if any).
         assert(h.leftStart >= leftPos);
         assert(h.rightStart >= rightPos);
         const std::size_t gapLeft = h.leftStart - leftPos;
         const std::size_t gapRight = h.rightStart - rightPos;
         assert(gapLeft == gapRight);
-        emit_equals(gapLeft);
-
-        // Emit edit rows.
-        for (const auto& dl : h.lines) {
-            if (dl.op == LineOp::Delete) {
-                rows.push_back(AlignedRow{
-                    .left = dl.leftIndex,
-                    .right = std::nullopt,
-                    .op = LineOp::Delete,
-                });
-            } else if (dl.op == LineOp::Insert) {
-                rows.push_back(AlignedRow{
-                    .left = std::nullopt,
-                    .right = dl.rightIndex,
-                    .op = LineOp::Insert,
-                });
-            } else {
-                // Defensive: equality lines can exist if hunks include context.
-                rows.push_back(AlignedRow{
-                    .left = dl.leftIndex,
-                    .right = dl.rightIndex,
-                    .op = LineOp::Equal,
-                });
-            }
-
-            apply_op_positions(dl.op, leftPos, rightPos);
+        (void)gapRight;
+        emit(LineOp::Equal, gapLeft);
+
+        for (const auto& run : h.runs) {
+            emit(run.op, run.length);
         }
 
         // Sanity-check computed end positions.
@@ -84,13 +50,100 @@ std::vector<AlignedRow> BuildAlignedRows(const DiffResult& r)
         assert(rightPos == h.rightStart + h.rightCount);
     }
 
-    // Emit trailing equal run.
+    // Trailing equal run.
     assert(r.leftLineCount >= leftPos);
     assert(r.rightLineCount >= rightPos);
     const std::size_t tailLeft = r.leftLineCount - leftPos;
-    const std::size_t tailRight = r.rightLineCount - rightPos;
-    assert(tailLeft == tailRight);
-    emit_equals(tailLeft);
+    assert(tailLeft == r.rightLineCount - rightPos);
+    emit(LineOp::Equal, tailLeft);
+
+    return runs;
+}
+
+AlignedRow RowInRun(const AlignedRun& run, std::size_t k)
+{
+    assert(k < run.length);
+    AlignedRow row;
+    row.op = run.op;
+    if (run.op != LineOp::Insert) {
+        row.left = run.leftStart + k;
+    }
+    if (run.op != LineOp::Delete) {
+        row.right = run.rightStart + k;
+    }
+    return row;
+}
+
+AlignedRowView::AlignedRowView(const DiffResult& r)
+    : AlignedRowView(BuildAlignedRuns(r))
+{
+}
+
+AlignedRowView::AlignedRowView(std::vector<AlignedRun> runs)
+    : m_runs(std::move(runs))
+{
+    m_rowStarts.reserve(m_runs.size() + 1);
+    std::size_t row = 0;
+    for (const auto& run : m_runs) {
+        m_rowStarts.push_back(row);
+        row += run.length;
+    }
+    m_rowStarts.push_back(row);
+}
+
+AlignedRow AlignedRowView::row(std::size_t i) const
+{
+    assert(i < rowCount());
+    // Last run starting at or before `i`. Runs are never empty, so starts are
+    // strictly increasing.
+    const auto it = std::upper_bound(m_rowStarts.begin(), m_rowStarts.end(), i) - 1;
+    const auto run = static_cast<std::size_t>(it - m_rowStarts.begin());
+    return RowInRun(m_runs[run], i - *it);
+}
+
+std::optional<std::size_t> AlignedRowView::rowForLeftLine(std::size_t line) const
+{
+    // Last run starting at or before `line` on the left. An Insert run shares
+    // its leftStart with the run after it, so it is only found at the very
+    // end, past the last left line.
+    const auto it = std::partition_point(m_runs.begin(), m_runs.end(), [line](const AlignedRun& run) {
+        return run.leftStart <= line;
+    });
+    if (it == m_runs.begin()) {
+        return std::nullopt;
+    }
+    const auto& run = *(it - 1);
+    if (run.op == LineOp::Insert || line >= run.leftStart + run.length) {
+        return std::nullopt;
+    }
+    return m_rowStarts[static_cast<std::size_t>(it - 1 - m_runs.begin())] + (line - run.leftStart);
+}
+
+std::optional<std::size_t> AlignedRowView::rowForRightLine(std::size_t line) const
+{
+    const auto it = std::partition_point(m_runs.begin(), m_runs.end(), [line](const AlignedRun& run) {
+        return run.rightStart <= line;
+    });
+    if (it == m_runs.begin()) {
+        return std::nullopt;
+    }
+    const auto& run = *(it - 1);
+    if (run.op == LineOp::Delete || line >= run.rightStart + run.length) {
+        return std::nullopt;
+    }
+    return m_rowStarts[static_cast<std::size_t>(it - 1 - m_runs.begin())] + (line - run.rightStart);
+}
+
+std::vector<AlignedRow> BuildAlignedRows(const DiffResult& r)
+{
+    std::vector<AlignedRow> rows;
+    rows.reserve(r.leftLineCount + r.rightLineCount);
+
+    for (const auto& run : BuildAlignedRuns(r)) {
+        for (std::size_t k = 0; k < run.length; ++k) {
+            rows.push_back(RowInRun(run, k));
+        }
+    }
 
     return rows;
 }
@@ -98,11 +151,9 @@ std::vector<AlignedRow> BuildAlignedRows(const DiffResult& r)
 std::vector<LineOp> LeftLineClassification(const DiffResult& r)
 {
     std::vector<LineOp> out(r.leftLineCount, LineOp::Equal);
-    for (const auto& h : r.hunks) {
-        for (const auto& dl : h.lines) {
-            if (dl.op == LineOp::Delete && dl.leftIndex != DiffLine::npos) {
-                out[dl.leftIndex] = LineOp::Delete;
-            }
+    for (const auto& run : BuildAlignedRuns(r)) {
+        if (run.op == LineOp::Delete) {
+            std::fill_n(out.begin() + static_cast<std::ptrdiff_t>(run.leftStart), run.length, LineOp::Delete);
         }
     }
     return out;
@@ -111,11 +162,9 @@ std::vector<LineOp> LeftLineClassification(const DiffResult& r)
 std::vector<LineOp> RightLineClassification(const DiffResult& r)
 {
     std::vector<LineOp> out(r.rightLineCount, LineOp::Equal);
-    for (const auto& h : r.hunks) {
-        for (const auto& dl : h.lines) {
-            if (dl.op == LineOp::Insert && dl.rightIndex != DiffLine::npos) {
-                out[dl.rightIndex] = LineOp::Insert;
-            }
+    for (const auto& run : BuildAlignedRuns(r)) {
+        if (run.op == LineOp::Insert) {
+            std::fill_n(out.begin() + static_cast<std::ptrdiff_t>(run.rightStart), run.length, LineOp::Insert);
         }
     }
     return out;
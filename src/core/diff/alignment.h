@@ -2,7 +2,9 @@
 
 #include <diff/diff.h>
 
+#include <cstddef>
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace bendiff::core::diff {
@@ -13,7 +15,56 @@ struct AlignedRow {
     LineOp op = LineOp::Equal;
 };
 
-// Builds a unified row stream suitable for side-by-side rendering.
+// `length` consecutive aligned rows with the same op. Row k of the run shows
+// left line leftStart + k (Equal, Delete) and/or right line rightStart + k
+// (Equal, Insert); the start of the side a run doesn't consume is where that
+// side stands.
+struct AlignedRun {
+    LineOp op = LineOp::Equal;
+    std::size_t leftStart = 0;
+    std::size_t rightStart = 0;
+    std::size_t length = 0;
+};
+
+// The unified row stream as runs: the equal stretches between hunks and each
+// hunk's edit runs, in order. O(hunks) in size, however long the files are.
+std::vector<AlignedRun> BuildAlignedRuns(const DiffResult& r);
+
+// Row `k` (< run.length) of `run`.
+AlignedRow RowInRun(const AlignedRun& run, std::size_t k);
+
+// Random access to the aligned rows without materializing them: keeps the
+// runs and their first rows, so a view can fetch just the rows on screen of
+// an arbitrarily long diff. Lookups are binary searches over the runs,
+// O(log hunks).
+class AlignedRowView {
+public:
+    AlignedRowView() = default;
+    explicit AlignedRowView(const DiffResult& r);
+    explicit AlignedRowView(std::vector<AlignedRun> runs);
+
+    std::size_t rowCount() const { return m_rowStarts.empty() ? 0 : m_rowStarts.back(); }
+
+    // Row `i` (< rowCount()).
+    AlignedRow row(std::size_t i) const;
+
+    // The row showing left (right) line `line`, or nullopt if there is no
+    // such line.
+    std::optional<std::size_t> rowForLeftLine(std::size_t line) const;
+    std::optional<std::size_t> rowForRightLine(std::size_t line) const;
+
+    std::span<const AlignedRun> runs() const { return m_runs; }
+
+    // First row of runs()[i]; runStart(runs().size()) == rowCount().
+    std::size_t runStart(std::size_t i) const { return m_rowStarts[i]; }
+
+private:
+    std::vector<AlignedRun> m_runs;
+    std::vector<std::size_t> m_rowStarts; // runs + 1 entries once built
+};
+
+// Builds a unified row stream suitable for side-by-side rendering (the rows
+// of BuildAlignedRuns(), one per displayed line).
 //
 // For Equal rows: both indices are present.
 // For Delete rows: left is present; right is nullopt.
@@ -1,10 +1,15 @@
 #include <diff/diff.h>
-#include <diff/whitespace.h>
+#include <diff/histogram.h>
+#include <diff/line_interning.h>
+#include <diff/myers.h>
+#include <loaded_text_file.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
@@ -14,170 +19,39 @@ namespace bendiff::core::diff {
 
 namespace {
 
-std::vector<std::string> BuildKeys(std::span<const std::string> lines, WhitespaceMode mode)
-{
-    std::vector<std::string> keys;
-    keys.reserve(lines.size());
-    for (const auto& line : lines) {
-        keys.push_back(MakeComparisonKey(line, mode));
-    }
-    return keys;
-}
+// Number of leading and trailing lines both sides have in common. The two
+// never overlap: prefix + suffix <= min(left.size(), right.size()).
+struct CommonAffixes {
+    std::size_t prefix = 0;
+    std::size_t suffix = 0;
+};
 
-std::vector<DiffLine> MyersDiffOps(const std::vector<std::string>& leftKeys, const std::vector<std::string>& rightKeys)
+CommonAffixes FindCommonAffixes(LineIds leftIds, LineIds rightIds)
 {
-    using coord_t = std::ptrdiff_t;
-    const coord_t n = static_cast<coord_t>(leftKeys.size());
-    const coord_t m = static_cast<coord_t>(rightKeys.size());
-
-    const coord_t maxD = n + m;
-    const coord_t offset = maxD;
-
-    std::vector<coord_t> v(static_cast<std::size_t>(2 * maxD + 1), -1);
-    v[static_cast<std::size_t>(offset + 1)] = 0;
-    std::vector<std::vector<coord_t>> trace;
-    trace.reserve(static_cast<std::size_t>(maxD + 1));
-
-    coord_t endX = 0;
-    coord_t endY = 0;
-
-    for (coord_t d = 0; d <= maxD; ++d) {
-        for (coord_t k = -d; k <= d; k += 2) {
-            coord_t x;
-            const auto idx = static_cast<std::size_t>(offset + k);
-            const auto idxKm1 = static_cast<std::size_t>(offset + (k - 1));
-            const auto idxKp1 = static_cast<std::size_t>(offset + (k + 1));
-
-            if (k == -d || (k != d && v[idxKm1] < v[idxKp1])) {
-                // Down (insertion in left->right transform).
-                x = v[idxKp1];
-            } else {
-                // Right (deletion in left->right transform).
-                x = v[idxKm1] + 1;
-            }
-
-            coord_t y = x - k;
-            while (x < n && y < m && leftKeys[static_cast<std::size_t>(x)] == rightKeys[static_cast<std::size_t>(y)]) {
-                ++x;
-                ++y;
-            }
-            v[idx] = x;
+    CommonAffixes out;
 
-            if (x >= n && y >= m) {
-                endX = x;
-                endY = y;
-                trace.push_back(v);
-                goto done;
-            }
-        }
-
-        trace.push_back(v);
+    const std::size_t limit = std::min(leftIds.size(), rightIds.size());
+    while (out.prefix < limit && leftIds[out.prefix] == rightIds[out.prefix]) {
+        ++out.prefix;
     }
 
-done:
-    // Backtrack.
-    coord_t x = endX;
-    coord_t y = endY;
-    std::vector<DiffLine> reversed;
-    reversed.reserve(static_cast<std::size_t>(n + m));
-
-    for (coord_t d = static_cast<coord_t>(trace.size()) - 1; d > 0; --d) {
-        const auto& vPrev = trace[static_cast<std::size_t>(d - 1)];
-        const coord_t k = x - y;
-
-        coord_t prevK;
-        const auto idxKm1 = static_cast<std::size_t>(offset + (k - 1));
-        const auto idxKp1 = static_cast<std::size_t>(offset + (k + 1));
-
-        if (k == -d || (k != d && vPrev[idxKm1] < vPrev[idxKp1])) {
-            prevK = k + 1;
-        } else {
-            prevK = k - 1;
-        }
-
-        const coord_t prevX = vPrev[static_cast<std::size_t>(offset + prevK)];
-        const coord_t prevY = prevX - prevK;
-
-        while (x > prevX && y > prevY) {
-            reversed.push_back(DiffLine{
-                .op = LineOp::Equal,
-                .leftIndex = static_cast<std::size_t>(x - 1),
-                .rightIndex = static_cast<std::size_t>(y - 1),
-            });
-            --x;
-            --y;
-        }
-
-        if (x == prevX) {
-            // Insertion (right element was added).
-            reversed.push_back(DiffLine{
-                .op = LineOp::Insert,
-                .leftIndex = DiffLine::npos,
-                .rightIndex = static_cast<std::size_t>(y - 1),
-            });
-            --y;
-        } else {
-            // Deletion (left element was removed).
-            reversed.push_back(DiffLine{
-                .op = LineOp::Delete,
-                .leftIndex = static_cast<std::size_t>(x - 1),
-                .rightIndex = DiffLine::npos,
-            });
-            --x;
-        }
+    const std::size_t suffixLimit = limit - out.prefix;
+    while (out.suffix < suffixLimit &&
+           leftIds[leftIds.size() - 1 - out.suffix] == rightIds[rightIds.size() - 1 - out.suffix]) {
+        ++out.suffix;
     }
 
-    while (x > 0 && y > 0) {
-        reversed.push_back(DiffLine{
-            .op = LineOp::Equal,
-            .leftIndex = static_cast<std::size_t>(x - 1),
-            .rightIndex = static_cast<std::size_t>(y - 1),
-        });
-        --x;
-        --y;
-    }
-    while (x > 0) {
-        reversed.push_back(DiffLine{
-            .op = LineOp::Delete,
-            .leftIndex = static_cast<std::size_t>(x - 1),
-            .rightIndex = DiffLine::npos,
-        });
-        --x;
-    }
-    while (y > 0) {
-        reversed.push_back(DiffLine{
-            .op = LineOp::Insert,
-            .leftIndex = DiffLine::npos,
-            .rightIndex = static_cast<std::size_t>(y - 1),
-        });
-        --y;
-    }
-
-    std::reverse(reversed.begin(), reversed.end());
-    return reversed;
+    return out;
 }
 
-std::vector<DiffHunk> BuildEditHunksZeroContext(const std::vector<DiffLine>& ops)
+// `ops` are relative to a window starting `offset` lines into both inputs
+// (the trimmed common prefix); hunks are re-based onto the inputs.
+std::vector<DiffHunk> BuildEditHunksZeroContext(const std::vector<DiffLine>& ops, std::size_t offset)
 {
     std::vector<DiffHunk> hunks;
 
-    std::size_t leftPos = 0;
-    std::size_t rightPos = 0;
-
-    auto advance_positions = [&](const DiffLine& dl) {
-        switch (dl.op) {
-        case LineOp::Equal:
-            ++leftPos;
-            ++rightPos;
-            break;
-        case LineOp::Delete:
-            ++leftPos;
-            break;
-        case LineOp::Insert:
-            ++rightPos;
-            break;
-        }
-    };
+    std::size_t leftPos = offset;
+    std::size_t rightPos = offset;
 
     DiffHunk current;
     bool inHunk = false;
@@ -194,7 +68,8 @@ std::vector<DiffHunk> BuildEditHunksZeroContext(const std::vector<DiffLine>& ops
     for (const auto& dl : ops) {
         if (dl.op == LineOp::Equal) {
             flush();
-            advance_positions(dl);
+            ++leftPos;
+            ++rightPos;
             continue;
         }
 
@@ -206,38 +81,159 @@ std::vector<DiffHunk> BuildEditHunksZeroContext(const std::vector<DiffLine>& ops
             current.rightCount = 0;
         }
 
-        current.lines.push_back(dl);
+        if (!current.runs.empty() && current.runs.back().op == dl.op) {
+            ++current.runs.back().length;
+        } else {
+            current.runs.push_back(EditRun{.op = dl.op, .length = 1});
+        }
         if (dl.op == LineOp::Delete) {
             ++current.leftCount;
-        } else if (dl.op == LineOp::Insert) {
+            ++leftPos;
+        } else {
             ++current.rightCount;
+            ++rightPos;
         }
-        advance_positions(dl);
     }
 
     flush();
     return hunks;
 }
 
-} // namespace
-
-DiffResult DiffLines(std::span<const std::string> left,
-                     std::span<const std::string> right,
-                     WhitespaceMode mode)
+// The DiffLines overloads differ only in how lines are interned: `intern()`
+// returns the InternedLines for a left side of `leftCount` lines and a right
+// side of `rightCount` lines.
+template <typename Intern>
+DiffResult DiffInterned(std::size_t leftCount,
+                        std::size_t rightCount,
+                        WhitespaceMode mode,
+                        const DiffOptions& options,
+                        Intern&& intern)
 {
     DiffResult r;
     r.mode = mode;
-    r.leftLineCount = left.size();
-    r.rightLineCount = right.size();
+    r.leftLineCount = leftCount;
+    r.rightLineCount = rightCount;
+
+    SearchLimits limits;
+    limits.maxTraceBytes = options.maxTraceBytes;
+    limits.maxEditCost = options.maxEditCost;
+    if (options.timeBudget.count() > 0) {
+        limits.deadline = std::chrono::steady_clock::now() + options.timeBudget;
+    }
+    limits.control = options.control;
+
+    const auto cancelled = [&r] {
+        r.cancelled = true;
+        return r;
+    };
+
+    if (options.control.StopRequested()) {
+        return cancelled();
+    }
+
+    const InternedLines ids = intern();
+    if (options.control.StopRequested()) {
+        return cancelled();
+    }
 
-    const auto leftKeys = BuildKeys(left, mode);
-    const auto rightKeys = BuildKeys(right, mode);
-    auto ops = MyersDiffOps(leftKeys, rightKeys);
+    // Only the window between the common prefix and suffix needs searching;
+    // for typical small edits that is a tiny fraction of the file.
+    const LineIds leftIds(ids.left);
+    const LineIds rightIds(ids.right);
+    const auto affixes = FindCommonAffixes(leftIds, rightIds);
+    const auto leftWindow = leftIds.subspan(affixes.prefix, leftIds.size() - affixes.prefix - affixes.suffix);
+    const auto rightWindow = rightIds.subspan(affixes.prefix, rightIds.size() - affixes.prefix - affixes.suffix);
+
+    EditScript script;
+    switch (options.algorithm) {
+    case DiffAlgorithm::Myers:
+        script = MyersDiffOps(leftWindow, rightWindow, limits);
+        break;
+    case DiffAlgorithm::Histogram:
+        script = HistogramDiffOps(leftWindow, rightWindow, ids.distinctCount, limits);
+        break;
+    }
+    if (script.cancelled) {
+        return cancelled();
+    }
 
     // M5-T3: produce a deterministic edit script.
     // M5-T4: split into contiguous edit hunks (no context in v1).
-    r.hunks = BuildEditHunksZeroContext(ops);
+    r.hunks = BuildEditHunksZeroContext(script.ops, affixes.prefix);
+    r.approximate = script.approximate;
+    options.control.ReportProgress(1.0);
     return r;
 }
 
+} // namespace
+
+std::vector<DiffLine> ExpandHunkLines(const DiffHunk& h)
+{
+    std::vector<DiffLine> out;
+    out.reserve(h.leftCount + h.rightCount);
+
+    std::size_t leftPos = h.leftStart;
+    std::size_t rightPos = h.rightStart;
+    for (const auto& run : h.runs) {
+        for (std::size_t i = 0; i < run.length; ++i) {
+            switch (run.op) {
+            case LineOp::Equal:
+                out.push_back(DiffLine{.op = LineOp::Equal, .leftIndex = leftPos++, .rightIndex = rightPos++});
+                break;
+            case LineOp::Delete:
+                out.push_back(DiffLine{.op = LineOp::Delete, .leftIndex = leftPos++, .rightIndex = DiffLine::npos});
+                break;
+            case LineOp::Insert:
+                out.push_back(DiffLine{.op = LineOp::Insert, .leftIndex = DiffLine::npos, .rightIndex = rightPos++});
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+DiffResult DiffLines(std::span<const std::string> left,
+                     std::span<const std::string> right,
+                     WhitespaceMode mode)
+{
+    return DiffLines(left, right, mode, DiffOptions{});
+}
+
+DiffResult DiffLines(std::span<const std::string> left,
+                     std::span<const std::string> right,
+                     WhitespaceMode mode,
+                     const DiffOptions& options)
+{
+    return DiffInterned(left.size(), right.size(), mode, options, [&] { return InternLines(left, right, mode); });
+}
+
+DiffResult DiffLines(const TextLines& left, const TextLines& right, WhitespaceMode mode)
+{
+    return DiffLines(left, right, mode, DiffOptions{});
+}
+
+DiffResult DiffLines(const TextLines& left,
+                     const TextLines& right,
+                     WhitespaceMode mode,
+                     const DiffOptions& options)
+{
+    return DiffInterned(left.size(), right.size(), mode, options, [&] { return InternLines(left, right, mode); });
+}
+
+DiffResult DiffLines(const LoadedTextFile& left,
+                     const LoadedTextFile& right,
+                     WhitespaceMode mode,
+                     const DiffOptions& options)
+{
+    // Files built by hand (rather than loaded) may lack hashes.
+    const bool hashed = left.hashes.size() == left.lines.size() && right.hashes.size() == right.lines.size();
+    if (!hashed) {
+        return DiffLines(left.lines, right.lines, mode, options);
+    }
+
+    return DiffInterned(left.lines.size(), right.lines.size(), mode, options, [&] {
+        return InternLines(left.lines, left.hashes.ForMode(mode), right.lines, right.hashes.ForMode(mode), mode);
+    });
+}
+
 } // namespace bendiff::core::diff
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <text_lines.h>
+#include <work_control.h>
+
+#include <chrono>
 #include <cstddef>
 #include <optional>
 #include <span>
 #include <string>
 #include <vector>
 
+namespace bendiff::core {
+struct LoadedTextFile;
+}
+
 namespace bendiff::core::diff {
 
 enum class WhitespaceMode {
@@ -33,20 +41,80 @@ struct DiffLine {
     static constexpr std::size_t npos = static_cast<std::size_t>(-1);
 };
 
+// Consecutive edit-script lines with the same op.
+struct EditRun {
+    LineOp op = LineOp::Equal;
+    std::size_t length = 0;
+};
+
 struct DiffHunk {
     std::size_t leftStart = 0;
     std::size_t leftCount = 0;
     std::size_t rightStart = 0;
     std::size_t rightCount = 0;
 
-    std::vector<DiffLine> lines;
+    // The hunk's edit script, in order, as runs rather than one entry per
+    // line: line indices follow from the starts, since Delete (and Equal)
+    // runs consume left lines from leftStart and Insert (and Equal) runs
+    // consume right lines from rightStart.
+    std::vector<EditRun> runs;
 };
 
+// One DiffLine per line of `h`, with indices filled in. For tests and tools;
+// the diff consumers iterate runs.
+std::vector<DiffLine> ExpandHunkLines(const DiffHunk& h);
+
 struct DiffResult {
     WhitespaceMode mode = WhitespaceMode::Exact;
     std::vector<DiffHunk> hunks;
     std::size_t leftLineCount = 0;
     std::size_t rightLineCount = 0;
+
+    // True if DiffOptions::maxEditCost or DiffOptions::timeBudget cut the
+    // search short: the hunks are a valid edit script, but not necessarily
+    // the smallest one.
+    bool approximate = false;
+
+    // True if DiffOptions::control requested a stop before the diff finished;
+    // `hunks` is then empty and the result must not be used.
+    bool cancelled = false;
+};
+
+enum class DiffAlgorithm {
+    // Shortest edit script (the v1 engine).
+    Myers,
+    // git's histogram diff: anchors on low-occurrence lines, which gives
+    // cleaner hunks and near-linear time on files with many repeated lines
+    // (braces, blank lines). Falls back to Myers for regions without anchors.
+    Histogram,
+};
+
+struct DiffOptions {
+    DiffAlgorithm algorithm = DiffAlgorithm::Myers;
+
+    // Upper bound on the memory the Myers search may spend recording its
+    // trace for the backtrack. Searches whose trace would exceed it switch to
+    // a linear-space backtrack that recomputes the trace in bisected segments:
+    // identical output, at the cost of roughly log2(D) extra forward passes.
+    std::size_t maxTraceBytes = std::size_t{64} * 1024 * 1024;
+
+    // Budgets for pathological inputs (e.g. two unrelated large files), where
+    // the exact search is O(N * D). 0 means unlimited; the defaults keep
+    // results exact and deterministic.
+    //
+    // maxEditCost: a Myers search that needs more than this many edits keeps
+    // the greedy path it found so far and restarts from its end, so the total
+    // work is roughly O((N + M) * maxEditCost).
+    //
+    // timeBudget: once spent, whatever has not been searched yet is reported
+    // as deleted and inserted.
+    std::size_t maxEditCost = 0;
+    std::chrono::milliseconds timeBudget{0};
+
+    // Cancellation and progress (see WorkControl). The engines poll the stop
+    // token between search steps, so a stop takes effect within milliseconds
+    // even on very large inputs.
+    WorkControl control;
 };
 
 // v1 line-diff entry point (algorithm implemented in Milestone 5).
@@ -54,4 +122,24 @@ DiffResult DiffLines(std::span<const std::string> left,
                      std::span<const std::string> right,
                      WhitespaceMode mode);
 
+DiffResult DiffLines(std::span<const std::string> left,
+                     std::span<const std::string> right,
+                     WhitespaceMode mode,
+                     const DiffOptions& options);
+
+// Same, straight from line stores (no per-line strings).
+DiffResult DiffLines(const TextLines& left, const TextLines& right, WhitespaceMode mode);
+
+DiffResult DiffLines(const TextLines& left,
+                     const TextLines& right,
+                     WhitespaceMode mode,
+                     const DiffOptions& options);
+
+// Same, for loaded files: interns with the key hashes computed while loading
+// (LoadedTextFile::hashes), so the text is not read again.
+DiffResult DiffLines(const LoadedTextFile& left,
+                     const LoadedTextFile& right,
+                     WhitespaceMode mode,
+                     const DiffOptions& options);
+
 } // namespace bendiff::core::diff
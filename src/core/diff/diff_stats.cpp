@@ -8,11 +8,11 @@ DiffStats ComputeDiffStats(const DiffResult& d)
     s.hunkCount = d.hunks.size();
 
     for (const auto& h : d.hunks) {
-        for (const auto& dl : h.lines) {
-            if (dl.op == LineOp::Insert) {
-                ++s.addedLineCount;
-            } else if (dl.op == LineOp::Delete) {
-                ++s.deletedLineCount;
+        for (const auto& run : h.runs) {
+            if (run.op == LineOp::Insert) {
+                s.addedLineCount += run.length;
+            } else if (run.op == LineOp::Delete) {
+                s.deletedLineCount += run.length;
             }
         }
     }
@@ -0,0 +1,281 @@
+#include <diff/histogram.h>
+#include <diff/myers.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace bendiff::core::diff {
+
+namespace {
+
+// Lines occurring more often than this on the left side of a region are not
+// used as anchors (git's default).
+constexpr std::uint32_t kMaxChainLength = 64;
+
+constexpr std::size_t kNone = static_cast<std::size_t>(-1);
+
+// Regions processed between progress reports.
+constexpr std::size_t kProgressInterval = 256;
+
+// Half-open line ranges on both sides.
+struct Region {
+    std::size_t leftBegin = 0;
+    std::size_t leftEnd = 0;
+    std::size_t rightBegin = 0;
+    std::size_t rightEnd = 0;
+};
+
+// A pending piece of output, processed in stack order: either a region still
+// to be diffed, or an anchor (a run of equal lines) to emit as-is.
+struct Task {
+    Region region;
+    bool isAnchor = false;
+};
+
+// Occurrences of each line ID among the left lines of the region being
+// searched. Chains link equal lines in ascending order. Reset after each
+// region, so the whole diff shares one allocation.
+struct HistogramIndex {
+    HistogramIndex(std::size_t distinctCount, std::size_t leftCount)
+        : count(distinctCount, 0)
+        , head(distinctCount, kNone)
+        , next(leftCount, kNone)
+    {
+    }
+
+    std::vector<std::uint32_t> count;
+    std::vector<std::size_t> head;
+    std::vector<std::size_t> next;
+};
+
+struct Lcs {
+    std::size_t leftBegin = 0;
+    std::size_t rightBegin = 0;
+    std::size_t length = 0;
+};
+
+enum class LcsOutcome {
+    Anchor,
+    NoCommonLines,
+    OnlyFrequentLines,
+};
+
+// Finds the anchor for `r`: the longest common run containing the left
+// side's lowest-occurrence lines. Mirrors git's xhistogram find_lcs/try_lcs.
+LcsOutcome FindLcs(LineIds left, LineIds right, const Region& r, HistogramIndex& index, Lcs& best)
+{
+    // Index back to front so that chains ascend.
+    for (std::size_t i = r.leftEnd; i-- > r.leftBegin;) {
+        const auto id = left[i];
+        index.next[i] = index.head[id];
+        index.head[id] = i;
+        ++index.count[id];
+    }
+
+    bool hasCommon = false;
+    bool found = false;
+    std::uint32_t bestCount = kMaxChainLength + 1;
+
+    for (std::size_t b = r.rightBegin; b < r.rightEnd;) {
+        std::size_t bNext = b + 1;
+        const auto occurrences = index.count[right[b]];
+
+        if (occurrences == 0) {
+            b = bNext;
+            continue;
+        }
+        hasCommon = true;
+        if (occurrences > bestCount) {
+            b = bNext;
+            continue;
+        }
+
+        for (std::size_t a = index.head[right[b]]; a != kNone;) {
+            // Extend the match in both directions; ends are inclusive.
+            std::size_t as = a;
+            std::size_t bs = b;
+            std::size_t ae = a;
+            std::size_t be = b;
+            std::uint32_t rc = occurrences;
+
+            while (as > r.leftBegin && bs > r.rightBegin && left[as - 1] == right[bs - 1]) {
+                --as;
+                --bs;
+                if (rc > 1) {
+                    rc = std::min(rc, index.count[left[as]]);
+                }
+            }
+            while (ae + 1 < r.leftEnd && be + 1 < r.rightEnd && left[ae + 1] == right[be + 1]) {
+                ++ae;
+                ++be;
+                if (rc > 1) {
+                    rc = std::min(rc, index.count[left[ae]]);
+                }
+            }
+
+            bNext = std::max(bNext, be + 1);
+
+            const std::size_t bestSpan = found ? best.length - 1 : 0;
+            if (bestSpan < ae - as || rc < bestCount) {
+                best = Lcs{.leftBegin = as, .rightBegin = bs, .length = ae - as + 1};
+                bestCount = rc;
+                found = true;
+            }
+
+            // Skip occurrences already covered by this run.
+            std::size_t nextA = index.next[a];
+            while (nextA != kNone && nextA <= ae) {
+                nextA = index.next[nextA];
+            }
+            a = nextA;
+        }
+
+        b = bNext;
+    }
+
+    for (std::size_t i = r.leftBegin; i < r.leftEnd; ++i) {
+        index.count[left[i]] = 0;
+        index.head[left[i]] = kNone;
+    }
+
+    if (hasCommon && bestCount > kMaxChainLength) {
+        return LcsOutcome::OnlyFrequentLines;
+    }
+    if (!found) {
+        return LcsOutcome::NoCommonLines;
+    }
+    return LcsOutcome::Anchor;
+}
+
+} // namespace
+
+EditScript HistogramDiffOps(LineIds leftIds,
+                            LineIds rightIds,
+                            std::size_t distinctCount,
+                            const SearchLimits& limits)
+{
+    EditScript out;
+    std::vector<DiffLine>& ops = out.ops;
+    ops.reserve(leftIds.size() + rightIds.size());
+
+    HistogramIndex index(distinctCount, leftIds.size());
+
+    // Myers fallbacks cover a single region; progress is reported per region
+    // here instead.
+    SearchLimits fallbackLimits = limits;
+    fallbackLimits.control.progress = nullptr;
+
+    const std::size_t progressTotal = leftIds.size() + rightIds.size();
+    std::size_t processed = 0;
+
+    // Explicit stack instead of recursion: anchors can nest as deep as the
+    // input is long.
+    std::vector<Task> stack;
+    stack.push_back(Task{.region = Region{
+                             .leftBegin = 0,
+                             .leftEnd = leftIds.size(),
+                             .rightBegin = 0,
+                             .rightEnd = rightIds.size(),
+                         }});
+
+    while (!stack.empty()) {
+        const Task task = stack.back();
+        stack.pop_back();
+        const Region& r = task.region;
+
+        if (limits.control.StopRequested()) {
+            ops.clear();
+            out.cancelled = true;
+            return out;
+        }
+
+        // Regions are processed in output order, so everything before this
+        // region's start has been emitted.
+        if (++processed % kProgressInterval == 0 && progressTotal > 0) {
+            limits.control.ReportProgress(static_cast<double>(r.leftBegin + r.rightBegin) /
+                                          static_cast<double>(progressTotal));
+        }
+
+        if (task.isAnchor) {
+            for (std::size_t i = 0; i < r.leftEnd - r.leftBegin; ++i) {
+                ops.push_back(DiffLine{
+                    .op = LineOp::Equal,
+                    .leftIndex = r.leftBegin + i,
+                    .rightIndex = r.rightBegin + i,
+                });
+            }
+            continue;
+        }
+
+        if (r.leftBegin == r.leftEnd || r.rightBegin == r.rightEnd) {
+            AppendReplaced(r.leftBegin, r.leftEnd, r.rightBegin, r.rightEnd, ops);
+            continue;
+        }
+
+        // Out of time: report the region as replaced instead of searching it.
+        if (limits.deadline.has_value() && std::chrono::steady_clock::now() >= *limits.deadline) {
+            AppendReplaced(r.leftBegin, r.leftEnd, r.rightBegin, r.rightEnd, ops);
+            out.approximate = true;
+            continue;
+        }
+
+        Lcs lcs;
+        switch (FindLcs(leftIds, rightIds, r, index, lcs)) {
+        case LcsOutcome::NoCommonLines:
+            AppendReplaced(r.leftBegin, r.leftEnd, r.rightBegin, r.rightEnd, ops);
+            break;
+
+        case LcsOutcome::OnlyFrequentLines: {
+            const auto sub = MyersDiffOps(leftIds.subspan(r.leftBegin, r.leftEnd - r.leftBegin),
+                                          rightIds.subspan(r.rightBegin, r.rightEnd - r.rightBegin),
+                                          fallbackLimits);
+            if (sub.cancelled) {
+                ops.clear();
+                out.cancelled = true;
+                return out;
+            }
+            out.approximate = out.approximate || sub.approximate;
+            out.peakTraceBytes = std::max(out.peakTraceBytes, sub.peakTraceBytes);
+            for (DiffLine dl : sub.ops) {
+                if (dl.leftIndex != DiffLine::npos) {
+                    dl.leftIndex += r.leftBegin;
+                }
+                if (dl.rightIndex != DiffLine::npos) {
+                    dl.rightIndex += r.rightBegin;
+                }
+                ops.push_back(dl);
+            }
+            break;
+        }
+
+        case LcsOutcome::Anchor:
+            // Pushed in reverse so the region before the anchor is emitted first.
+            stack.push_back(Task{.region = Region{
+                                     .leftBegin = lcs.leftBegin + lcs.length,
+                                     .leftEnd = r.leftEnd,
+                                     .rightBegin = lcs.rightBegin + lcs.length,
+                                     .rightEnd = r.rightEnd,
+                                 }});
+            stack.push_back(Task{.region = Region{
+                                     .leftBegin = lcs.leftBegin,
+                                     .leftEnd = lcs.leftBegin + lcs.length,
+                                     .rightBegin = lcs.rightBegin,
+                                     .rightEnd = lcs.rightBegin + lcs.length,
+                                 },
+                                 .isAnchor = true});
+            stack.push_back(Task{.region = Region{
+                                     .leftBegin = r.leftBegin,
+                                     .leftEnd = lcs.leftBegin,
+                                     .rightBegin = r.rightBegin,
+                                     .rightEnd = lcs.rightBegin,
+                                 }});
+            break;
+        }
+    }
+
+    return out;
+}
+
+} // namespace bendiff::core::diff
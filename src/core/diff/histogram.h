@@ -0,0 +1,28 @@
+#pragma once
+
+#include <diff/diff.h>
+#include <diff/line_interning.h>
+#include <diff/myers.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace bendiff::core::diff {
+
+// Histogram diff (the algorithm behind `git diff --histogram`).
+//
+// Recursively anchors on the longest common run that contains the
+// lowest-occurrence lines of the left side, then diffs the regions before and
+// after it. Regions whose common lines all occur too often to be good anchors
+// fall back to Myers (see MyersDiffOps).
+//
+// `distinctCount` is InternedLines::distinctCount (every ID is below it).
+// Regions still pending when `limits.deadline` passes are reported as
+// replaced; `limits` also applies to every Myers fallback. Polls
+// `limits.control` once per region.
+EditScript HistogramDiffOps(LineIds leftIds,
+                            LineIds rightIds,
+                            std::size_t distinctCount,
+                            const SearchLimits& limits);
+
+} // namespace bendiff::core::diff
@@ -0,0 +1,153 @@
+#include <diff/line_hashes.h>
+
+#include <bit>
+#include <cstring>
+
+namespace bendiff::core::diff {
+
+namespace {
+
+inline bool IsWs(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Streaming hash over bytes, 8 at a time. Feeding the same bytes gives the
+// same hash however they are split across Byte()/Bytes() calls, so a key can
+// be hashed while whitespace is being skipped.
+class KeyHasher {
+public:
+    void Byte(unsigned char c)
+    {
+        m_word |= std::uint64_t{c} << (8 * m_pending);
+        ++m_length;
+        if (++m_pending == 8) {
+            Mix(m_word);
+            m_word = 0;
+            m_pending = 0;
+        }
+    }
+
+    void Bytes(std::string_view s)
+    {
+        std::size_t i = 0;
+        if constexpr (std::endian::native == std::endian::little) {
+            if (m_pending == 0) {
+                for (; i + 8 <= s.size(); i += 8) {
+                    std::uint64_t w = 0;
+                    std::memcpy(&w, s.data() + i, 8);
+                    Mix(w);
+                }
+                m_length += i;
+            }
+        }
+        for (; i < s.size(); ++i) {
+            Byte(static_cast<unsigned char>(s[i]));
+        }
+    }
+
+    std::uint64_t Finish() const
+    {
+        std::uint64_t h = m_hash;
+        if (m_pending > 0) {
+            h = MixInto(h, m_word);
+        }
+        // splitmix64 finalizer over the state and length.
+        h ^= m_length * 0x9E3779B97F4A7C15ull;
+        h ^= h >> 30;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 27;
+        h *= 0x94D049BB133111EBull;
+        h ^= h >> 31;
+        return h;
+    }
+
+private:
+    static std::uint64_t MixInto(std::uint64_t h, std::uint64_t w)
+    {
+        h ^= w * 0x87C37B91114253D5ull;
+        return std::rotl(h, 31) * 0x4CF5AD432745937Full;
+    }
+
+    void Mix(std::uint64_t w) { m_hash = MixInto(m_hash, w); }
+
+    std::uint64_t m_hash = 0x243F6A8885A308D3ull;
+    std::uint64_t m_word = 0;
+    std::uint64_t m_length = 0;
+    unsigned m_pending = 0;
+};
+
+std::size_t TrimmedLength(std::string_view line)
+{
+    std::size_t end = line.size();
+    while (end > 0 && IsWs(line[end - 1])) {
+        --end;
+    }
+    return end;
+}
+
+std::uint64_t HashBytes(std::string_view s)
+{
+    KeyHasher h;
+    h.Bytes(s);
+    return h.Finish();
+}
+
+std::uint64_t HashWithoutWs(std::string_view s)
+{
+    KeyHasher h;
+    for (const char c : s) {
+        if (!IsWs(c)) {
+            h.Byte(static_cast<unsigned char>(c));
+        }
+    }
+    return h.Finish();
+}
+
+} // namespace
+
+std::uint64_t HashComparisonKey(std::string_view line, WhitespaceMode mode)
+{
+    switch (mode) {
+    case WhitespaceMode::Exact:
+        return HashBytes(line);
+    case WhitespaceMode::IgnoreTrailing:
+        return HashBytes(line.substr(0, TrimmedLength(line)));
+    case WhitespaceMode::IgnoreAll:
+        return HashWithoutWs(line);
+    }
+    return HashBytes(line);
+}
+
+void LineHashes::Reserve(std::size_t lineCount)
+{
+    exact.reserve(lineCount);
+    ignoreTrailing.reserve(lineCount);
+    ignoreAll.reserve(lineCount);
+}
+
+void LineHashes::Append(std::string_view line)
+{
+    const auto exactHash = HashBytes(line);
+    const auto trimmed = TrimmedLength(line);
+
+    exact.push_back(exactHash);
+    // Most lines have no trailing whitespace: reuse the exact hash then.
+    ignoreTrailing.push_back(trimmed == line.size() ? exactHash : HashBytes(line.substr(0, trimmed)));
+    ignoreAll.push_back(HashWithoutWs(line.substr(0, trimmed)));
+}
+
+std::span<const std::uint64_t> LineHashes::ForMode(WhitespaceMode mode) const
+{
+    switch (mode) {
+    case WhitespaceMode::Exact:
+        break;
+    case WhitespaceMode::IgnoreTrailing:
+        return ignoreTrailing;
+    case WhitespaceMode::IgnoreAll:
+        return ignoreAll;
+    }
+    return exact;
+}
+
+} // namespace bendiff::core::diff
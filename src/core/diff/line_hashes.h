@@ -0,0 +1,37 @@
+#pragma once
+
+#include <diff/diff.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace bendiff::core::diff {
+
+// 64-bit hash of a line's comparison key (see MakeComparisonKey) under
+// `mode`, computed without building the key. Equal keys hash equally; equal
+// hashes must still be confirmed with ComparisonKeysEqual.
+std::uint64_t HashComparisonKey(std::string_view line, WhitespaceMode mode);
+
+// Comparison-key hashes of a file's lines under every WhitespaceMode, filled
+// in while the file is loaded so that diffing (in any mode) does not have to
+// walk the text again.
+struct LineHashes {
+    std::vector<std::uint64_t> exact;
+    std::vector<std::uint64_t> ignoreTrailing;
+    std::vector<std::uint64_t> ignoreAll;
+
+    std::size_t size() const { return exact.size(); }
+
+    void Reserve(std::size_t lineCount);
+
+    // Hashes `line` for all three modes (reading it while it is still in
+    // cache from splitting).
+    void Append(std::string_view line);
+
+    std::span<const std::uint64_t> ForMode(WhitespaceMode mode) const;
+};
+
+} // namespace bendiff::core::diff
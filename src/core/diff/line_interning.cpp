@@ -0,0 +1,125 @@
+#include <diff/line_interning.h>
+#include <diff/line_hashes.h>
+#include <diff/whitespace.h>
+
+#include <string_view>
+#include <unordered_map>
+
+namespace bendiff::core::diff {
+
+namespace {
+
+using InternTable = std::unordered_map<ComparisonKey, std::uint32_t, ComparisonKeyHash>;
+
+void InternSide(std::span<const std::string> lines, WhitespaceMode mode, InternTable& table, std::vector<std::uint32_t>& out)
+{
+    out.reserve(lines.size());
+    for (const auto& line : lines) {
+        const auto nextId = static_cast<std::uint32_t>(table.size());
+        const auto [it, inserted] = table.try_emplace(ComparisonKey(line, mode), nextId);
+        (void)inserted;
+        out.push_back(it->second);
+    }
+}
+
+// Interning by precomputed key hash. Each hash remembers the first line seen
+// with it; a later line with the same hash and an equal key shares its ID.
+// Genuine collisions (same hash, different key) are rare and are interned by
+// key in a side table.
+class HashedInterner {
+public:
+    HashedInterner(WhitespaceMode mode, std::size_t expectedLines)
+        : m_mode(mode)
+    {
+        m_byHash.reserve(expectedLines);
+    }
+
+    void InternSide(const TextLines& lines, std::span<const std::uint64_t> hashes, std::vector<std::uint32_t>& out)
+    {
+        out.reserve(lines.size());
+        for (std::size_t i = 0; i < lines.size(); ++i) {
+            out.push_back(Intern(lines[i], hashes[i]));
+        }
+    }
+
+    std::size_t distinctCount() const { return m_nextId; }
+
+private:
+    std::uint32_t Intern(std::string_view line, std::uint64_t hash)
+    {
+        const auto [it, inserted] = m_byHash.try_emplace(hash, Entry{.line = line, .id = m_nextId});
+        if (inserted) {
+            return m_nextId++;
+        }
+        if (ComparisonKeysEqual(it->second.line, line, m_mode)) {
+            return it->second.id;
+        }
+
+        const auto [cit, cinserted] = m_collisions.try_emplace(ComparisonKey(line, m_mode), m_nextId);
+        if (cinserted) {
+            ++m_nextId;
+        }
+        return cit->second;
+    }
+
+    struct Entry {
+        std::string_view line;
+        std::uint32_t id = 0;
+    };
+
+    WhitespaceMode m_mode;
+    std::uint32_t m_nextId = 0;
+    std::unordered_map<std::uint64_t, Entry> m_byHash;
+    InternTable m_collisions;
+};
+
+std::vector<std::uint64_t> HashSide(const TextLines& lines, WhitespaceMode mode)
+{
+    std::vector<std::uint64_t> out;
+    out.reserve(lines.size());
+    for (const auto line : lines) {
+        out.push_back(HashComparisonKey(line, mode));
+    }
+    return out;
+}
+
+} // namespace
+
+InternedLines InternLines(std::span<const std::string> left,
+                          std::span<const std::string> right,
+                          WhitespaceMode mode)
+{
+    InternedLines out;
+
+    InternTable table;
+    table.reserve(left.size() + right.size());
+
+    InternSide(left, mode, table, out.left);
+    InternSide(right, mode, table, out.right);
+
+    out.distinctCount = table.size();
+    return out;
+}
+
+InternedLines InternLines(const TextLines& left, const TextLines& right, WhitespaceMode mode)
+{
+    return InternLines(left, HashSide(left, mode), right, HashSide(right, mode), mode);
+}
+
+InternedLines InternLines(const TextLines& left,
+                          std::span<const std::uint64_t> leftHashes,
+                          const TextLines& right,
+                          std::span<const std::uint64_t> rightHashes,
+                          WhitespaceMode mode)
+{
+    InternedLines out;
+
+    HashedInterner interner(mode, left.size() + right.size());
+    interner.InternSide(left, leftHashes, out.left);
+    interner.InternSide(right, rightHashes, out.right);
+
+    out.distinctCount = interner.distinctCount();
+    return out;
+}
+
+} // namespace bendiff::core::diff
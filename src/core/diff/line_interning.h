@@ -0,0 +1,47 @@
+#pragma once
+
+#include <diff/diff.h>
+#include <text_lines.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace bendiff::core::diff {
+
+// A view of interned line IDs; equal IDs <=> equal comparison keys.
+using LineIds = std::span<const std::uint32_t>;
+
+// Dense integer IDs for the lines of both sides of a diff.
+//
+// Two lines get the same ID iff their comparison keys (see MakeComparisonKey)
+// are equal under the chosen whitespace mode, on either side. IDs are assigned
+// in first-seen order (left side first), so they are deterministic and lie in
+// [0, distinctCount).
+struct InternedLines {
+    std::vector<std::uint32_t> left;
+    std::vector<std::uint32_t> right;
+    std::size_t distinctCount = 0;
+};
+
+// Keys each line once (a borrowed ComparisonKey, so no per-line allocation)
+// and interns it into a table shared by both sides, so the diff engine
+// compares lines with a single integer compare.
+InternedLines InternLines(std::span<const std::string> left,
+                          std::span<const std::string> right,
+                          WhitespaceMode mode);
+
+InternedLines InternLines(const TextLines& left, const TextLines& right, WhitespaceMode mode);
+
+// Same, from each line's comparison-key hash under `mode` (see LineHashes):
+// lines are only compared (with ComparisonKeysEqual) when their hashes match,
+// and no keys are built.
+InternedLines InternLines(const TextLines& left,
+                          std::span<const std::uint64_t> leftHashes,
+                          const TextLines& right,
+                          std::span<const std::uint64_t> rightHashes,
+                          WhitespaceMode mode);
+
+} // namespace bendiff::core::diff
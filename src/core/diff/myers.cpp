@@ -0,0 +1,482 @@
+#include <diff/myers.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <stop_token>
+#include <utility>
+#include <vector>
+
+namespace bendiff::core::diff {
+
+namespace {
+
+using coord_t = std::ptrdiff_t;
+
+// Furthest-reaching x per diagonal after D-step `d` of the Myers search, for
+// diagonals k = -d, -d+2, ..., d (index i <-> k = -d + 2i).
+//
+// Step d+1 only ever reads these d+1 values, so a frontier is the complete
+// search state; the classic full-width `v` array holds nothing else of use.
+using Frontier = std::vector<coord_t>;
+
+struct MyersEnd {
+    coord_t x = 0;
+    coord_t y = 0;
+};
+
+// Computes the frontier of step `d` from `prev` (the frontier of step d-1;
+// ignored for d == 0). Returns the end point if step `d` reaches (n, m).
+std::optional<MyersEnd> AdvanceFrontier(LineIds leftIds,
+                                        LineIds rightIds,
+                                        const Frontier& prev,
+                                        coord_t d,
+                                        Frontier& next)
+{
+    const coord_t n = static_cast<coord_t>(leftIds.size());
+    const coord_t m = static_cast<coord_t>(rightIds.size());
+
+    next.resize(static_cast<std::size_t>(d + 1));
+
+    for (coord_t i = 0; i <= d; ++i) {
+        const coord_t k = -d + 2 * i;
+        coord_t x;
+
+        if (d == 0) {
+            x = 0;
+        } else if (k == -d || (k != d && prev[static_cast<std::size_t>(i - 1)] < prev[static_cast<std::size_t>(i)])) {
+            // Down (insertion in left->right transform).
+            x = prev[static_cast<std::size_t>(i)];
+        } else {
+            // Right (deletion in left->right transform).
+            x = prev[static_cast<std::size_t>(i - 1)] + 1;
+        }
+
+        coord_t y = x - k;
+        while (x < n && y < m && leftIds[static_cast<std::size_t>(x)] == rightIds[static_cast<std::size_t>(y)]) {
+            ++x;
+            ++y;
+        }
+        next[static_cast<std::size_t>(i)] = x;
+
+        if (x >= n && y >= m) {
+            return MyersEnd{.x = x, .y = y};
+        }
+    }
+
+    return std::nullopt;
+}
+
+// Walks the final path back across D-step `d`: emits the step's snake and its
+// single edit (in reverse order) and moves (x, y) to the end of step d-1.
+// `prev` is the frontier of step d-1.
+void BacktrackStep(const Frontier& prev, coord_t d, coord_t& x, coord_t& y, std::vector<DiffLine>& reversed)
+{
+    const coord_t k = x - y;
+    const auto at = [&](coord_t diag) {
+        return prev[static_cast<std::size_t>((diag + d - 1) / 2)];
+    };
+
+    coord_t prevK;
+    if (k == -d || (k != d && at(k - 1) < at(k + 1))) {
+        prevK = k + 1;
+    } else {
+        prevK = k - 1;
+    }
+
+    const coord_t prevX = at(prevK);
+    const coord_t prevY = prevX - prevK;
+
+    while (x > prevX && y > prevY) {
+        reversed.push_back(DiffLine{
+            .op = LineOp::Equal,
+            .leftIndex = static_cast<std::size_t>(x - 1),
+            .rightIndex = static_cast<std::size_t>(y - 1),
+        });
+        --x;
+        --y;
+    }
+
+    if (x == prevX) {
+        // Insertion (right element was added).
+        reversed.push_back(DiffLine{
+            .op = LineOp::Insert,
+            .leftIndex = DiffLine::npos,
+            .rightIndex = static_cast<std::size_t>(y - 1),
+        });
+        --y;
+    } else {
+        // Deletion (left element was removed).
+        reversed.push_back(DiffLine{
+            .op = LineOp::Delete,
+            .leftIndex = static_cast<std::size_t>(x - 1),
+            .rightIndex = DiffLine::npos,
+        });
+        --x;
+    }
+}
+
+// Bytes of frontiers currently held for the backtrack, and the most held at
+// any point.
+struct TraceMeter {
+    std::size_t live = 0;
+    std::size_t peak = 0;
+
+    void Hold(const Frontier& f)
+    {
+        live += f.size() * sizeof(coord_t);
+        peak = std::max(peak, live);
+    }
+
+    void Release(std::size_t bytes) { live -= bytes; }
+};
+
+// Segments whose recomputed trace fits in this many bytes are backtracked
+// directly; larger ones are bisected first.
+constexpr std::size_t kLinearLeafTraceBytes = 4 * 1024 * 1024;
+
+// Linear-space backtrack over D-steps (lo, hi].
+//
+// Instead of keeping the frontier of every step, recompute them from the
+// frontier of step `lo`: bisect the step range, backtrack the upper half from
+// a recomputed mid-point frontier, then the lower half. Only O(log D)
+// frontiers are alive at once, and because the frontiers are recomputed
+// exactly, the resulting path is identical to the full-trace backtrack.
+//
+// Gives up (leaving `reversed` incomplete) once `stop` is requested.
+void BacktrackLinear(LineIds leftIds,
+                     LineIds rightIds,
+                     const Frontier& loFrontier,
+                     coord_t lo,
+                     coord_t hi,
+                     const std::stop_token& stop,
+                     TraceMeter& meter,
+                     coord_t& x,
+                     coord_t& y,
+                     std::vector<DiffLine>& reversed)
+{
+    if (hi <= lo || stop.stop_requested()) {
+        return;
+    }
+
+    const auto steps = static_cast<std::size_t>(hi - lo);
+    const auto leafBytes = steps * static_cast<std::size_t>(hi) * sizeof(coord_t);
+
+    if (steps == 1 || leafBytes <= kLinearLeafTraceBytes) {
+        // trace[i] is the frontier of step lo + i.
+        std::vector<Frontier> trace;
+        trace.reserve(steps);
+        trace.push_back(loFrontier);
+        meter.Hold(trace.back());
+        const auto release = [&] {
+            for (const auto& f : trace) {
+                meter.Release(f.size() * sizeof(coord_t));
+            }
+        };
+        for (coord_t d = lo + 1; d < hi; ++d) {
+            if (stop.stop_requested()) {
+                release();
+                return;
+            }
+            Frontier next;
+            (void)AdvanceFrontier(leftIds, rightIds, trace.back(), d, next);
+            trace.push_back(std::move(next));
+            meter.Hold(trace.back());
+        }
+
+        for (coord_t d = hi; d > lo; --d) {
+            BacktrackStep(trace[static_cast<std::size_t>(d - 1 - lo)], d, x, y, reversed);
+        }
+        release();
+        return;
+    }
+
+    const coord_t mid = lo + (hi - lo) / 2;
+
+    Frontier midFrontier = loFrontier;
+    Frontier scratch;
+    for (coord_t d = lo + 1; d <= mid; ++d) {
+        if (stop.stop_requested()) {
+            return;
+        }
+        (void)AdvanceFrontier(leftIds, rightIds, midFrontier, d, scratch);
+        std::swap(midFrontier, scratch);
+    }
+    scratch.clear();
+    scratch.shrink_to_fit();
+
+    meter.Hold(midFrontier);
+    BacktrackLinear(leftIds, rightIds, midFrontier, mid, hi, stop, meter, x, y, reversed);
+    meter.Release(midFrontier.size() * sizeof(coord_t));
+
+    midFrontier.clear();
+    midFrontier.shrink_to_fit();
+    BacktrackLinear(leftIds, rightIds, loFrontier, lo, mid, stop, meter, x, y, reversed);
+}
+
+enum class SearchStop {
+    Reached,
+    CostBudget,
+    Deadline,
+    Cancelled,
+};
+
+// Ops from (0, 0) to (x, y), where (x, y) is (n, m) unless the search was cut
+// off by a budget. Meaningless if cancelled.
+struct SearchResult {
+    std::vector<DiffLine> ops;
+    coord_t x = 0;
+    coord_t y = 0;
+    SearchStop stop = SearchStop::Reached;
+    std::size_t peakTraceBytes = 0;
+};
+
+// Cut-off point for an unfinished search: the frontier point that got
+// furthest along (max x + y) without leaving the edit graph; the first such
+// point in ascending diagonal order wins ties.
+std::optional<MyersEnd> FurthestInBounds(const Frontier& frontier, coord_t d, coord_t n, coord_t m)
+{
+    std::optional<MyersEnd> best;
+    for (coord_t i = 0; i <= d; ++i) {
+        const coord_t k = -d + 2 * i;
+        const coord_t x = frontier[static_cast<std::size_t>(i)];
+        const coord_t y = x - k;
+        if (x > n || y > m) {
+            continue;
+        }
+        if (!best || x + y > best->x + best->y) {
+            best = MyersEnd{.x = x, .y = y};
+        }
+    }
+    return best;
+}
+
+bool DeadlinePassed(const SearchLimits& limits)
+{
+    return limits.deadline.has_value() && std::chrono::steady_clock::now() >= *limits.deadline;
+}
+
+// Steps between progress reports (and FurthestInBounds scans) of a search.
+constexpr coord_t kProgressInterval = 64;
+
+// `progressBase`/`progressTotal` map this search's x + y onto the progress
+// fraction reported through `limits.control`.
+SearchResult SearchAndBacktrack(LineIds leftIds,
+                                LineIds rightIds,
+                                const SearchLimits& limits,
+                                std::size_t progressBase,
+                                std::size_t progressTotal)
+{
+    const coord_t n = static_cast<coord_t>(leftIds.size());
+    const coord_t m = static_cast<coord_t>(rightIds.size());
+    const auto maxCost = static_cast<coord_t>(limits.maxEditCost);
+
+    SearchResult out;
+
+    // Forward pass. The frontier of every step is recorded for the backtrack
+    // until the recorded trace would exceed `maxTraceBytes`; past that point
+    // the search continues without recording and the linear-space backtrack
+    // recomputes what it needs.
+    std::vector<Frontier> trace;
+    std::size_t traceBytes = 0;
+    bool recordTrace = true;
+    TraceMeter meter;
+
+    Frontier first;
+    Frontier cur;
+    Frontier next;
+    MyersEnd end;
+    coord_t endD = 0;
+
+    for (coord_t d = 0;; ++d) {
+        const auto reached = AdvanceFrontier(leftIds, rightIds, cur, d, next);
+        std::swap(cur, next);
+
+        if (reached.has_value()) {
+            end = *reached;
+            endD = d;
+            break;
+        }
+
+        if (limits.control.StopRequested()) {
+            out.stop = SearchStop::Cancelled;
+            return out;
+        }
+
+        if (limits.control.progress && progressTotal > 0 && d % kProgressInterval == 0) {
+            if (const auto at = FurthestInBounds(cur, d, n, m)) {
+                const auto covered = progressBase + static_cast<std::size_t>(at->x + at->y);
+                limits.control.ReportProgress(static_cast<double>(covered) / static_cast<double>(progressTotal));
+            }
+        }
+
+        if (d == 0) {
+            first = cur;
+            meter.Hold(first);
+        } else {
+            // Budget checks come after the step so every cut-off makes progress
+            // (any point on frontier d has x + y >= d).
+            std::optional<SearchStop> stop;
+            if (maxCost > 0 && d >= maxCost) {
+                stop = SearchStop::CostBudget;
+            } else if (DeadlinePassed(limits)) {
+                stop = SearchStop::Deadline;
+            }
+
+            if (stop.has_value()) {
+                const auto cut = FurthestInBounds(cur, d, n, m);
+                if (!cut.has_value()) {
+                    // Nothing usable to backtrack from; the caller treats the
+                    // whole region as replaced.
+                    out.stop = SearchStop::Deadline;
+                    return out;
+                }
+                end = *cut;
+                endD = d;
+                out.stop = *stop;
+                break;
+            }
+        }
+
+        if (recordTrace) {
+            const auto bytes = cur.size() * sizeof(coord_t);
+            if (traceBytes + bytes > limits.maxTraceBytes) {
+                recordTrace = false;
+                meter.Release(traceBytes);
+                trace.clear();
+                trace.shrink_to_fit();
+            } else {
+                traceBytes += bytes;
+                trace.push_back(cur);
+                meter.Hold(trace.back());
+            }
+        }
+    }
+
+    // Backtrack.
+    coord_t x = end.x;
+    coord_t y = end.y;
+    out.x = x;
+    out.y = y;
+    std::vector<DiffLine>& reversed = out.ops;
+    reversed.reserve(static_cast<std::size_t>(x + y));
+
+    if (recordTrace) {
+        for (coord_t d = endD; d > 0; --d) {
+            BacktrackStep(trace[static_cast<std::size_t>(d - 1)], d, x, y, reversed);
+        }
+    } else {
+        BacktrackLinear(leftIds, rightIds, first, 0, endD, limits.control.stop, meter, x, y, reversed);
+        if (limits.control.StopRequested()) {
+            out.stop = SearchStop::Cancelled;
+            return out;
+        }
+    }
+
+    while (x > 0 && y > 0) {
+        reversed.push_back(DiffLine{
+            .op = LineOp::Equal,
+            .leftIndex = static_cast<std::size_t>(x - 1),
+            .rightIndex = static_cast<std::size_t>(y - 1),
+        });
+        --x;
+        --y;
+    }
+    while (x > 0) {
+        reversed.push_back(DiffLine{
+            .op = LineOp::Delete,
+            .leftIndex = static_cast<std::size_t>(x - 1),
+            .rightIndex = DiffLine::npos,
+        });
+        --x;
+    }
+    while (y > 0) {
+        reversed.push_back(DiffLine{
+            .op = LineOp::Insert,
+            .leftIndex = DiffLine::npos,
+            .rightIndex = static_cast<std::size_t>(y - 1),
+        });
+        --y;
+    }
+
+    std::reverse(reversed.begin(), reversed.end());
+    out.peakTraceBytes = meter.peak;
+    return out;
+}
+
+} // namespace
+
+void AppendReplaced(std::size_t leftBegin,
+                    std::size_t leftEnd,
+                    std::size_t rightBegin,
+                    std::size_t rightEnd,
+                    std::vector<DiffLine>& ops)
+{
+    for (std::size_t i = leftBegin; i < leftEnd; ++i) {
+        ops.push_back(DiffLine{
+            .op = LineOp::Delete,
+            .leftIndex = i,
+            .rightIndex = DiffLine::npos,
+        });
+    }
+    for (std::size_t i = rightBegin; i < rightEnd; ++i) {
+        ops.push_back(DiffLine{
+            .op = LineOp::Insert,
+            .leftIndex = DiffLine::npos,
+            .rightIndex = i,
+        });
+    }
+}
+
+EditScript MyersDiffOps(LineIds leftIds, LineIds rightIds, const SearchLimits& limits)
+{
+    EditScript out;
+    out.ops.reserve(leftIds.size() + rightIds.size());
+
+    // Each pass searches what is left of the inputs. A pass cut off by the
+    // cost budget keeps its (greedy) path up to the furthest frontier point
+    // and the next pass continues from there; after the deadline the rest is
+    // reported as replaced outright.
+    std::size_t leftPos = 0;
+    std::size_t rightPos = 0;
+
+    while (true) {
+        const auto r = SearchAndBacktrack(leftIds.subspan(leftPos),
+                                          rightIds.subspan(rightPos),
+                                          limits,
+                                          leftPos + rightPos,
+                                          leftIds.size() + rightIds.size());
+        out.peakTraceBytes = std::max(out.peakTraceBytes, r.peakTraceBytes);
+        if (r.stop == SearchStop::Cancelled) {
+            out.ops.clear();
+            out.cancelled = true;
+            return out;
+        }
+
+        for (DiffLine dl : r.ops) {
+            if (dl.leftIndex != DiffLine::npos) {
+                dl.leftIndex += leftPos;
+            }
+            if (dl.rightIndex != DiffLine::npos) {
+                dl.rightIndex += rightPos;
+            }
+            out.ops.push_back(dl);
+        }
+
+        if (r.stop == SearchStop::Reached) {
+            return out;
+        }
+
+        out.approximate = true;
+        leftPos += static_cast<std::size_t>(r.x);
+        rightPos += static_cast<std::size_t>(r.y);
+
+        if (r.stop == SearchStop::Deadline) {
+            AppendReplaced(leftPos, leftIds.size(), rightPos, rightIds.size(), out.ops);
+            return out;
+        }
+    }
+}
+
+} // namespace bendiff::core::diff
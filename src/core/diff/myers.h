@@ -0,0 +1,61 @@
+#pragma once
+
+#include <diff/diff.h>
+#include <diff/line_interning.h>
+#include <work_control.h>
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace bendiff::core::diff {
+
+// Resource limits for one DiffLines call, shared by all engine invocations
+// (see DiffOptions for the meaning of each).
+struct SearchLimits {
+    std::size_t maxTraceBytes = 0;
+    std::size_t maxEditCost = 0; // 0 = unlimited
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    WorkControl control;
+};
+
+// Engine output: the full op stream (Equal/Delete/Insert) with indices
+// relative to the engine's inputs.
+struct EditScript {
+    std::vector<DiffLine> ops;
+
+    // True if a budget cut the search short, so the script is valid but not
+    // necessarily minimal.
+    bool approximate = false;
+
+    // True if `SearchLimits::control` requested a stop; `ops` is then empty.
+    bool cancelled = false;
+
+    // Most bytes of search frontiers held at once for the backtrack (the
+    // recorded trace, or the linear-space backtrack's segments). Bounded by
+    // roughly `SearchLimits::maxTraceBytes` whatever the input.
+    std::size_t peakTraceBytes = 0;
+};
+
+// Myers O(ND) shortest edit script between two interned line sequences.
+//
+// Deterministic: among equally short scripts, the greedy forward search's
+// tie-breaking decides (deletes before inserts). When a search exceeds
+// `limits.maxEditCost`, the greedy path to its furthest frontier point is kept
+// and the search restarts from there; once `limits.deadline` passes, the
+// remainder is reported as replaced. Either way the result is approximate.
+//
+// Polls `limits.control` once per D-step and reports the fraction of both
+// inputs covered by the furthest-reaching path.
+EditScript MyersDiffOps(LineIds leftIds, LineIds rightIds, const SearchLimits& limits);
+
+// Appends Delete ops for left [leftBegin, leftEnd) followed by Insert ops for
+// right [rightBegin, rightEnd).
+void AppendReplaced(std::size_t leftBegin,
+                    std::size_t leftEnd,
+                    std::size_t rightBegin,
+                    std::size_t rightEnd,
+                    std::vector<DiffLine>& ops);
+
+} // namespace bendiff::core::diff
@@ -1,4 +1,5 @@
 #include <diff/whitespace.h>
+#include <diff/line_hashes.h>
 
 #include <cstddef>
 
@@ -11,6 +12,15 @@ inline bool is_ws(char c)
     return c == ' ' || c == '\t' || c == '\r';
 }
 
+std::string_view trim_trailing_ws(std::string_view line)
+{
+    std::size_t end = line.size();
+    while (end > 0 && is_ws(line[end - 1])) {
+        --end;
+    }
+    return line.substr(0, end);
+}
+
 } // namespace
 
 std::string MakeComparisonKey(std::string_view line, WhitespaceMode mode)
@@ -19,13 +29,8 @@ std::string MakeComparisonKey(std::string_view line, WhitespaceMode mode)
     case WhitespaceMode::Exact:
         return std::string(line);
 
-    case WhitespaceMode::IgnoreTrailing: {
-        std::size_t end = line.size();
-        while (end > 0 && is_ws(line[end - 1])) {
-            --end;
-        }
-        return std::string(line.substr(0, end));
-    }
+    case WhitespaceMode::IgnoreTrailing:
+        return std::string(trim_trailing_ws(line));
 
     case WhitespaceMode::IgnoreAll: {
         std::string out;
@@ -43,4 +48,58 @@ std::string MakeComparisonKey(std::string_view line, WhitespaceMode mode)
     return std::string(line);
 }
 
+ComparisonKey::ComparisonKey(std::string_view line, WhitespaceMode mode)
+    : m_text(mode == WhitespaceMode::IgnoreTrailing ? trim_trailing_ws(line) : line)
+    , m_mode(mode)
+    , m_hash(HashComparisonKey(line, mode))
+{
+}
+
+bool operator==(const ComparisonKey& a, const ComparisonKey& b)
+{
+    if (a.m_hash != b.m_hash) {
+        return false;
+    }
+    // IgnoreTrailing keys are already trimmed, so only IgnoreAll needs the
+    // whitespace-skipping compare.
+    if (a.m_mode == WhitespaceMode::IgnoreAll) {
+        return ComparisonKeysEqual(a.m_text, b.m_text, WhitespaceMode::IgnoreAll);
+    }
+    return a.m_text == b.m_text;
+}
+
+bool ComparisonKeysEqual(std::string_view a, std::string_view b, WhitespaceMode mode)
+{
+    switch (mode) {
+    case WhitespaceMode::Exact:
+        return a == b;
+
+    case WhitespaceMode::IgnoreTrailing:
+        return trim_trailing_ws(a) == trim_trailing_ws(b);
+
+    case WhitespaceMode::IgnoreAll: {
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (true) {
+            while (i < a.size() && is_ws(a[i])) {
+                ++i;
+            }
+            while (j < b.size() && is_ws(b[j])) {
+                ++j;
+            }
+            if (i == a.size() || j == b.size()) {
+                return i == a.size() && j == b.size();
+            }
+            if (a[i] != b[j]) {
+                return false;
+            }
+            ++i;
+            ++j;
+        }
+    }
+    }
+
+    return a == b;
+}
+
 } // namespace bendiff::core::diff
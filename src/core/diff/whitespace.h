@@ -2,6 +2,8 @@
 
 #include <diff/diff.h>
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <string_view>
 
@@ -11,6 +13,43 @@ namespace bendiff::core::diff {
 //
 // Whitespace definition (v1): ASCII space ' ', tab '\t', and carriage return '\r'.
 // (Lines are expected to be newline-split already, so '\n' should not be present.)
+//
+// Builds a new string; hot paths use ComparisonKey instead.
 std::string MakeComparisonKey(std::string_view line, WhitespaceMode mode);
 
+// A line's comparison key without building it, so keying a whole file does
+// no heap allocation. Exact and IgnoreTrailing keys are views of the (trimmed)
+// line; an IgnoreAll key views the whole line and skips whitespace while
+// hashing and comparing. Valid only while the line's storage is.
+//
+// Two keys compare equal iff MakeComparisonKey would give equal strings; keys
+// made under different modes must not be compared.
+class ComparisonKey {
+public:
+    ComparisonKey(std::string_view line, WhitespaceMode mode);
+
+    // The bytes the key is read from (for IgnoreAll, including whitespace).
+    std::string_view text() const { return m_text; }
+    WhitespaceMode mode() const { return m_mode; }
+
+    // HashComparisonKey() of the line, computed once on construction.
+    std::uint64_t hash() const { return m_hash; }
+
+    friend bool operator==(const ComparisonKey& a, const ComparisonKey& b);
+
+private:
+    std::string_view m_text;
+    WhitespaceMode m_mode;
+    std::uint64_t m_hash;
+};
+
+// Hasher for unordered containers keyed by ComparisonKey.
+struct ComparisonKeyHash {
+    std::size_t operator()(const ComparisonKey& key) const { return static_cast<std::size_t>(key.hash()); }
+};
+
+// MakeComparisonKey(a, mode) == MakeComparisonKey(b, mode), without building
+// either key.
+bool ComparisonKeysEqual(std::string_view a, std::string_view b, WhitespaceMode mode);
+
 } // namespace bendiff::core::diff
@@ -0,0 +1,54 @@
+#include "diff_session.h"
+
+#include <utility>
+
+namespace bendiff::core {
+
+DiffSession::DiffSession(LoadedTextFile left, LoadedTextFile right)
+    : m_left(std::move(left))
+    , m_right(std::move(right))
+{
+}
+
+std::size_t DiffSession::Slot(diff::WhitespaceMode mode)
+{
+    switch (mode) {
+    case diff::WhitespaceMode::Exact:
+        return 0;
+    case diff::WhitespaceMode::IgnoreTrailing:
+        return 1;
+    case diff::WhitespaceMode::IgnoreAll:
+        return 2;
+    }
+    return 0;
+}
+
+diff::DiffResult DiffSession::Diff(diff::WhitespaceMode mode, const diff::DiffOptions& options)
+{
+    if (auto cached = CachedDiff(mode)) {
+        return std::move(*cached);
+    }
+
+    // Diff without holding the lock, so other modes (and cancellations) are
+    // not held up. Two jobs racing on the same mode both compute it; the
+    // first to finish is kept.
+    auto result = diff::DiffLines(m_left, m_right, mode, options);
+    if (result.cancelled) {
+        return result;
+    }
+
+    std::lock_guard lock(m_mutex);
+    auto& slot = m_diffs[Slot(mode)];
+    if (!slot) {
+        slot = result;
+    }
+    return *slot;
+}
+
+std::optional<diff::DiffResult> DiffSession::CachedDiff(diff::WhitespaceMode mode) const
+{
+    std::lock_guard lock(m_mutex);
+    return m_diffs[Slot(mode)];
+}
+
+} // namespace bendiff::core
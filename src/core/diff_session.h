@@ -0,0 +1,44 @@
+#pragma once
+
+#include <diff/diff.h>
+#include <loaded_text_file.h>
+
+#include <array>
+#include <mutex>
+#include <optional>
+
+namespace bendiff::core {
+
+// One file pair being viewed: the loaded sides plus their diff, memoized per
+// whitespace mode.
+//
+// The sides are loaded once, with the comparison-key hashes for every mode
+// (LoadedTextFile::hashes), so switching to a new mode only runs the diff
+// search and switching back to a mode already seen is a lookup.
+//
+// Thread-safe: background jobs may diff the same session concurrently.
+class DiffSession {
+public:
+    DiffSession(LoadedTextFile left, LoadedTextFile right);
+
+    const LoadedTextFile& left() const { return m_left; }
+    const LoadedTextFile& right() const { return m_right; }
+
+    // The diff under `mode`, computed with `options` the first time the mode
+    // is asked for. A cancelled result is returned but not kept.
+    diff::DiffResult Diff(diff::WhitespaceMode mode, const diff::DiffOptions& options);
+
+    // The memoized diff under `mode`, if one has been computed.
+    std::optional<diff::DiffResult> CachedDiff(diff::WhitespaceMode mode) const;
+
+private:
+    static std::size_t Slot(diff::WhitespaceMode mode);
+
+    const LoadedTextFile m_left;
+    const LoadedTextFile m_right;
+
+    mutable std::mutex m_mutex;
+    std::array<std::optional<diff::DiffResult>, 3> m_diffs;
+};
+
+} // namespace bendiff::core
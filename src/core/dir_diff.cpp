@@ -1,14 +1,23 @@
 #include "dir_diff.h"
 
+#include "content_hash_cache.h"
 #include "dir_walk.h"
 #include "file_compare.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <filesystem>
-#include <fstream>
-#include <set>
 #include <system_error>
+#include <thread>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace fs = std::filesystem;
 
@@ -26,77 +35,228 @@ fs::path make_abs_if_possible(fs::path p)
     return p;
 }
 
-bool can_open_for_read(const fs::path& p)
+// Whether `p` could be opened for reading. On POSIX this asks the kernel
+// (with the effective ids, as open would) instead of opening the file.
+bool is_readable(const fs::path& p)
 {
+#if defined(_WIN32)
     std::ifstream in(p, std::ios::binary);
     return in.is_open();
+#else
+    return ::faccessat(AT_FDCWD, p.c_str(), R_OK, AT_EACCESS) == 0;
+#endif
 }
 
-fs::path full_path(const fs::path& root, const std::string& relativePath)
+fs::path full_path(const fs::path& root, std::string_view relativePath)
 {
     fs::path rel = fs::path(relativePath);
     rel.make_preferred();
     return root / rel;
 }
 
+// Reading files is latency-bound; a few workers per core keep an SSD busy
+// without thrashing a spinning disk too badly.
+constexpr std::size_t kMaxCompareThreads = 16;
+
+// Entries each worker claims at a time, to keep the shared counter cold.
+constexpr std::size_t kCompareBatch = 16;
+
+// Where an entry's path exists; decides what the compare stage does with it.
+enum class Presence : std::uint8_t {
+    Both,
+    LeftOnly,
+    RightOnly,
+};
+
+// What the compare stage knows about an entry before touching either file.
+struct Pending {
+    Presence presence = Presence::Both;
+    FileMetadata left;
+    FileMetadata right;
+};
+
+DirEntryStatus to_status(FileCompareResult r)
+{
+    switch (r) {
+        case FileCompareResult::Same:
+            return DirEntryStatus::Same;
+        case FileCompareResult::Different:
+            return DirEntryStatus::Different;
+        case FileCompareResult::Unreadable:
+            return DirEntryStatus::Unreadable;
+    }
+    return DirEntryStatus::Unreadable;
+}
+
+// Same-size pair, both sides present. Unchanged files are settled from their
+// recorded hashes without being read. Otherwise the pair is compared
+// bytewise, stopping at the first difference as without a cache, and hashed
+// in the same pass; hashes are recorded only for files read to the end.
+DirEntryStatus compare_with_cache(const DirDiffResult& result,
+                                  std::string_view rel,
+                                  const Pending& pending,
+                                  ContentHashCache& hashCache)
+{
+    const fs::path leftPath = full_path(result.leftRoot, rel);
+    const fs::path rightPath = full_path(result.rightRoot, rel);
+
+    const auto leftHash = hashCache.Lookup(leftPath, pending.left);
+    const auto rightHash = hashCache.Lookup(rightPath, pending.right);
+    if (leftHash && rightHash) {
+        return *leftHash == *rightHash ? DirEntryStatus::Same : DirEntryStatus::Different;
+    }
+
+    const auto compared = CompareAndHashFiles(leftPath, rightPath);
+    if (compared.leftHash) {
+        hashCache.Store(leftPath, pending.left, *compared.leftHash);
+    }
+    if (compared.rightHash) {
+        hashCache.Store(rightPath, pending.right, *compared.rightHash);
+    }
+    return to_status(compared.result);
+}
+
+DirEntryStatus classify(const DirDiffResult& result,
+                        std::string_view rel,
+                        const Pending& pending,
+                        ContentHashCache* hashCache)
+{
+    switch (pending.presence) {
+        case Presence::Both:
+            // The walk's stats settle the common cases without opening
+            // anything: both sides being one file (difftool symlinks into
+            // the worktree), or the sizes differing.
+            if (IsSameFile(pending.left, pending.right)) {
+                return DirEntryStatus::Same;
+            }
+            if (pending.left.valid && pending.right.valid && pending.left.size != pending.right.size) {
+                return DirEntryStatus::Different;
+            }
+            if (hashCache) {
+                return compare_with_cache(result, rel, pending, *hashCache);
+            }
+            return to_status(CompareFilesBytewise(full_path(result.leftRoot, rel), full_path(result.rightRoot, rel)));
+        case Presence::LeftOnly:
+            return is_readable(full_path(result.leftRoot, rel)) ? DirEntryStatus::LeftOnly : DirEntryStatus::Unreadable;
+        case Presence::RightOnly:
+            return is_readable(full_path(result.rightRoot, rel)) ? DirEntryStatus::RightOnly : DirEntryStatus::Unreadable;
+    }
+    return DirEntryStatus::Unreadable;
+}
+
+// Sets every entry's status, on up to `threads` workers. Each entry is
+// written by exactly one worker, in place, so the order is untouched.
+void classify_all(DirDiffResult& result,
+                  const std::vector<Pending>& pending,
+                  std::size_t threads,
+                  ContentHashCache* hashCache)
+{
+    const std::size_t count = result.entries.size();
+    std::atomic<std::size_t> next{0};
+
+    const auto work = [&] {
+        while (true) {
+            const std::size_t begin = next.fetch_add(kCompareBatch);
+            if (begin >= count) {
+                return;
+            }
+            const std::size_t end = std::min(count, begin + kCompareBatch);
+            for (std::size_t i = begin; i < end; ++i) {
+                auto& entry = result.entries[i];
+                entry.status = classify(result, entry.relativePath(), pending[i], hashCache);
+            }
+        }
+    };
+
+    threads = std::min(threads, (count + kCompareBatch - 1) / kCompareBatch);
+    if (threads <= 1) {
+        work();
+        return;
+    }
+
+    std::vector<std::jthread> pool;
+    pool.reserve(threads);
+    for (std::size_t t = 0; t < threads; ++t) {
+        pool.emplace_back(work);
+    }
+}
+
 } // namespace
 
 DirDiffResult DiffDirectories(const fs::path& leftRootIn, const fs::path& rightRootIn)
+{
+    return DiffDirectories(leftRootIn, rightRootIn, DirDiffOptions{});
+}
+
+DirDiffResult DiffDirectories(const fs::path& leftRootIn, const fs::path& rightRootIn, const DirDiffOptions& options)
 {
     DirDiffResult result;
     result.leftRoot = make_abs_if_possible(leftRootIn);
     result.rightRoot = make_abs_if_possible(rightRootIn);
 
-    const auto leftFiles = ListFilesRecursive(result.leftRoot);
-    const auto rightFiles = ListFilesRecursive(result.rightRoot);
-
-    std::set<std::string> leftSet(leftFiles.begin(), leftFiles.end());
-    std::set<std::string> rightSet(rightFiles.begin(), rightFiles.end());
-
-    std::set<std::string> all;
-    all.insert(leftSet.begin(), leftSet.end());
-    all.insert(rightSet.begin(), rightSet.end());
+    const DirWalkOptions walk{.threads = options.walkThreads};
+    const auto leftFiles = ListFilesWithMetadata(result.leftRoot, walk);
+    const auto rightFiles = ListFilesWithMetadata(result.rightRoot, walk);
 
-    result.entries.reserve(all.size());
-
-    for (const auto& rel : all) {
-        const bool inLeft = leftSet.contains(rel);
-        const bool inRight = rightSet.contains(rel);
-
-        DirEntry entry;
-        entry.relativePath = rel;
+    // Both lists are sorted, so their union is a linear merge. The merged
+    // paths go into one pool, which every entry shares.
+    TextLines::Builder pool;
+    std::size_t poolBytes = 0;
+    for (const auto& file : leftFiles) {
+        poolBytes += file.relativePath.size();
+    }
+    for (const auto& file : rightFiles) {
+        poolBytes += file.relativePath.size();
+    }
+    pool.Reserve(poolBytes, leftFiles.size() + rightFiles.size());
 
-        if (inLeft && inRight) {
-            const fs::path leftFull = full_path(result.leftRoot, rel);
-            const fs::path rightFull = full_path(result.rightRoot, rel);
+    std::vector<Pending> pending;
+    pending.reserve(leftFiles.size() + rightFiles.size());
 
-            const auto cmp = CompareFilesBytewise(leftFull, rightFull);
-            switch (cmp) {
-                case FileCompareResult::Same:
-                    entry.status = DirEntryStatus::Same;
-                    break;
-                case FileCompareResult::Different:
-                    entry.status = DirEntryStatus::Different;
-                    break;
-                case FileCompareResult::Unreadable:
-                    entry.status = DirEntryStatus::Unreadable;
-                    break;
-            }
-        } else if (inLeft) {
-            const fs::path leftFull = full_path(result.leftRoot, rel);
-            entry.status = can_open_for_read(leftFull) ? DirEntryStatus::LeftOnly : DirEntryStatus::Unreadable;
+    std::size_t l = 0;
+    std::size_t r = 0;
+    while (l < leftFiles.size() || r < rightFiles.size()) {
+        if (r == rightFiles.size()
+            || (l < leftFiles.size() && leftFiles[l].relativePath < rightFiles[r].relativePath)) {
+            pool.Append(leftFiles[l].relativePath);
+            pending.push_back({.presence = Presence::LeftOnly, .left = leftFiles[l].metadata, .right = {}});
+            ++l;
+        } else if (l == leftFiles.size() || rightFiles[r].relativePath < leftFiles[l].relativePath) {
+            pool.Append(rightFiles[r].relativePath);
+            pending.push_back({.presence = Presence::RightOnly, .left = {}, .right = rightFiles[r].metadata});
+            ++r;
         } else {
-            const fs::path rightFull = full_path(result.rightRoot, rel);
-            entry.status = can_open_for_read(rightFull) ? DirEntryStatus::RightOnly : DirEntryStatus::Unreadable;
+            pool.Append(leftFiles[l].relativePath);
+            pending.push_back({.presence = Presence::Both, .left = leftFiles[l].metadata, .right = rightFiles[r].metadata});
+            ++l;
+            ++r;
         }
+    }
 
-        result.entries.push_back(std::move(entry));
+    result.paths = pool.Finish();
+    result.entries.reserve(result.paths.size());
+    for (std::size_t i = 0; i < result.paths.size(); ++i) {
+        result.entries.push_back(DirEntry{.paths = result.paths, .pathIndex = i});
     }
 
-    // `all` is already lexicographically sorted, but keep this explicit for stability if implementation changes.
-    std::sort(result.entries.begin(), result.entries.end(), [](const DirEntry& a, const DirEntry& b) {
-        return a.relativePath < b.relativePath;
-    });
+    // The entries are in path order; the compare stage fills in statuses
+    // without reordering.
+    std::size_t threads = options.compareThreads;
+    if (threads == 0) {
+        threads = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, kMaxCompareThreads);
+    }
+    const auto compareStart = std::chrono::steady_clock::now();
+    if (options.hashCache) {
+        options.hashCache->BeginPass();
+    }
+    classify_all(result, pending, threads, options.hashCache);
+    if (options.hashCache) {
+        // Records the pass didn't use are for files that are gone, one-sided
+        // or changed; keep the cache to what the trees hold now.
+        options.hashCache->PruneUnder(result.leftRoot);
+        options.hashCache->PruneUnder(result.rightRoot);
+    }
+    result.compareTime = std::chrono::steady_clock::now() - compareStart;
 
     return result;
 }
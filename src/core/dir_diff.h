@@ -2,10 +2,28 @@
 
 #include "dir_diff_model.h"
 
+#include <cstddef>
 #include <filesystem>
 
 namespace bendiff::core {
 
+class ContentHashCache;
+
+struct DirDiffOptions {
+    // Files read at once by the compare stage (0 = one per core, up to a
+    // small cap). Output order does not depend on it.
+    std::size_t compareThreads = 0;
+
+    // Threads each of the two tree walks uses (see DirWalkOptions::threads).
+    std::size_t walkThreads = 0;
+
+    // If set, files present on both sides are compared by content hash,
+    // taken from the cache where a file's metadata is unchanged and recorded
+    // in it otherwise; records under the roots that the compare no longer
+    // needed are dropped. The caller loads and saves the cache.
+    ContentHashCache* hashCache = nullptr;
+};
+
 // Diffs two directory trees.
 //
 // v1 contract:
@@ -14,7 +32,18 @@ namespace bendiff::core {
 // - Classify LeftOnly/RightOnly/Same/Different/Unreadable
 // - Do not ignore special directories like .git
 // - Return stable ordering (lexicographic by relativePath)
+//
+// Files are compared (and one-sided files probed for readability) on a
+// bounded pool of worker threads, which keeps a fast disk's queue busy.
+//
+// The walk stats every file, so a path whose two sides are the same file
+// (same device and inode) is Same, and one whose sizes differ is Different,
+// without either file being opened or checked for readability.
 DirDiffResult DiffDirectories(const std::filesystem::path& leftRoot,
                              const std::filesystem::path& rightRoot);
 
+DirDiffResult DiffDirectories(const std::filesystem::path& leftRoot,
+                             const std::filesystem::path& rightRoot,
+                             const DirDiffOptions& options);
+
 } // namespace bendiff::core
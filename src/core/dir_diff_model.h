@@ -1,7 +1,11 @@
 #pragma once
 
+#include <text_lines.h>
+
+#include <chrono>
+#include <cstddef>
 #include <filesystem>
-#include <string>
+#include <string_view>
 #include <vector>
 
 namespace bendiff::core {
@@ -15,15 +19,28 @@ enum class DirEntryStatus {
 };
 
 struct DirEntry {
-    std::string relativePath;
+    // The entry's path is line `pathIndex` of `paths`: the owning result's
+    // shared pool, so an entry copied out of its result keeps its path.
+    TextLines paths;
+    std::size_t pathIndex = 0;
     DirEntryStatus status = DirEntryStatus::Same;
     bool isBinaryHint = false;
+
+    std::string_view relativePath() const { return paths[pathIndex]; }
 };
 
 struct DirDiffResult {
     std::filesystem::path leftRoot;
     std::filesystem::path rightRoot;
+
+    // Every entry's relative path, in entry order, packed into one shared
+    // buffer rather than a string per entry. Copies of the result share it.
+    TextLines paths;
+
     std::vector<DirEntry> entries;
+
+    // Wall time the compare stage took, walks excluded (for benchmarks).
+    std::chrono::nanoseconds compareTime{0};
 };
 
 } // namespace bendiff::core
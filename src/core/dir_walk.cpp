@@ -1,31 +1,65 @@
 #include "dir_walk.h"
 
+#include <algorithm>
 #include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#include <chrono>
+#else
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
 
 namespace fs = std::filesystem;
 
 namespace bendiff::core {
 
-std::vector<std::string> ListFilesRecursive(fs::path root)
+namespace {
+
+// Enough workers to keep a fast disk's queue busy; beyond this the walk is
+// bound by the kernel's directory locks rather than by latency.
+constexpr std::size_t kMaxWalkThreads = 8;
+
+bool ByPath(const WalkedFile& a, const WalkedFile& b)
 {
-    std::vector<std::string> results;
+    return a.relativePath < b.relativePath;
+}
 
+bool IsWalkableRoot(const fs::path& root)
+{
     std::error_code ec;
     if (root.empty()) {
-        return results;
+        return false;
     }
-
     if (!fs::exists(root, ec) || ec) {
-        return results;
+        return false;
     }
-    ec.clear();
+    return fs::is_directory(root, ec) && !ec;
+}
 
-    if (!fs::is_directory(root, ec) || ec) {
-        return results;
-    }
-    ec.clear();
+#if defined(_WIN32)
 
-    // Prefer an absolute root for stable relative-path computation.
+std::vector<WalkedFile> WalkSequential(fs::path root, bool withMetadata)
+{
+    std::vector<WalkedFile> results;
+
+    std::error_code ec;
     const fs::path abs = fs::absolute(root, ec);
     if (!ec && !abs.empty()) {
         root = abs;
@@ -43,24 +77,345 @@ std::vector<std::string> ListFilesRecursive(fs::path root)
             ec.clear();
             continue;
         }
-        ec.clear();
 
-        const fs::path p = it->path();
-        const fs::path rel = fs::relative(p, root, ec);
-        if (ec) {
-            ec.clear();
+        // The iterator yields root / relative, so the relative part is the
+        // path's tail; no need to canonicalize through fs::relative.
+        const fs::path rel = it->path().lexically_relative(root);
+        const std::string relStr = rel.generic_string();
+        if (relStr.empty() || relStr == ".") {
             continue;
         }
 
-        const std::string relStr = rel.generic_string();
-        if (relStr.empty() || relStr == ".") {
+        WalkedFile file{.relativePath = relStr, .metadata = {}};
+        if (withMetadata) {
+            // The iterator caches these from the directory listing.
+            const auto size = it->file_size(ec);
+            const auto mtime = ec ? fs::file_time_type() : it->last_write_time(ec);
+            if (!ec) {
+                file.metadata = FileMetadata{
+                    .size = static_cast<std::uint64_t>(size),
+                    .mtimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count(),
+                    .device = 0,
+                    .inode = 0,
+                    .valid = true,
+                };
+            }
+            ec.clear();
+        }
+        results.push_back(std::move(file));
+    }
+
+    return results;
+}
+
+#else
+
+enum class EntryKind {
+    File,
+    Directory,
+    Other,
+};
+
+// Kind of entry `name` in `dirFd`, given the type readdir reported. Symlinks
+// count as files only if they point at one (matching is_regular_file()), and
+// are never descended into.
+EntryKind Classify(int dirFd, const char* name, unsigned char type)
+{
+    struct stat st {};
+    switch (type) {
+    case DT_REG:
+        return EntryKind::File;
+    case DT_DIR:
+        return EntryKind::Directory;
+    case DT_LNK:
+        if (::fstatat(dirFd, name, &st, 0) == 0 && S_ISREG(st.st_mode)) {
+            return EntryKind::File;
+        }
+        return EntryKind::Other;
+    case DT_UNKNOWN:
+        // Some filesystems don't fill in d_type.
+        if (::fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            return EntryKind::Other;
+        }
+        if (S_ISREG(st.st_mode)) {
+            return EntryKind::File;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            return EntryKind::Directory;
+        }
+        if (S_ISLNK(st.st_mode)) {
+            return Classify(dirFd, name, DT_LNK);
+        }
+        return EntryKind::Other;
+    default:
+        return EntryKind::Other;
+    }
+}
+
+bool IsDotOrDotDot(const char* name)
+{
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+FileMetadata MetadataFromStat(const struct stat& st)
+{
+#if defined(__APPLE__)
+    const auto& mtime = st.st_mtimespec;
+#else
+    const auto& mtime = st.st_mtim;
+#endif
+    return FileMetadata{
+        .size = static_cast<std::uint64_t>(st.st_size),
+        .mtimeNs = static_cast<std::int64_t>(mtime.tv_sec) * 1'000'000'000 + mtime.tv_nsec,
+        .device = static_cast<std::uint64_t>(st.st_dev),
+        .inode = static_cast<std::uint64_t>(st.st_ino),
+        .valid = true,
+    };
+}
+
+// Calls fn(name, d_type) for each entry of the directory open at `fd` (except
+// "." and ".."). Takes ownership of `fd`.
+template <typename Fn>
+void ForEachEntry(int fd, Fn&& fn)
+{
+#if defined(__linux__)
+    // Raw getdents64: one syscall fills a large buffer with entries, with no
+    // DIR stream or per-entry allocation. glibc's dirent64 has the kernel's
+    // record layout.
+    alignas(struct dirent64) char buf[32 * 1024];
+    while (true) {
+        const long n = ::syscall(SYS_getdents64, fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) {
             continue;
         }
+        if (n <= 0) {
+            break;
+        }
+        for (long off = 0; off < n;) {
+            const auto* d = reinterpret_cast<const struct dirent64*>(buf + off);
+            if (!IsDotOrDotDot(d->d_name)) {
+                fn(d->d_name, d->d_type);
+            }
+            off += d->d_reclen;
+        }
+    }
+    ::close(fd);
+#else
+    DIR* dir = ::fdopendir(fd);
+    if (!dir) {
+        ::close(fd);
+        return;
+    }
+    while (const dirent* d = ::readdir(dir)) {
+        if (!IsDotOrDotDot(d->d_name)) {
+            fn(d->d_name, d->d_type);
+        }
+    }
+    ::closedir(dir);
+#endif
+}
+
+// Work-stealing walk: each worker owns a deque of directories (relative to
+// the root) still to read. It takes from the back of its own (depth first,
+// warm in cache) and, when empty, steals from the front of another's (the
+// shallowest, likely largest subtrees). All directories are opened relative
+// to the root fd, so only one fd per worker is open at a time.
+class ParallelWalker {
+public:
+    ParallelWalker(int rootFd, std::size_t threadCount, bool withMetadata)
+        : m_rootFd(rootFd)
+        , m_withMetadata(withMetadata)
+    {
+        m_workers.reserve(threadCount);
+        for (std::size_t i = 0; i < threadCount; ++i) {
+            m_workers.push_back(std::make_unique<Worker>());
+        }
+    }
+
+    std::vector<WalkedFile> Run()
+    {
+        Push(0, std::string());
+
+        if (m_workers.size() == 1) {
+            Work(0);
+        } else {
+            std::vector<std::jthread> threads;
+            threads.reserve(m_workers.size());
+            for (std::size_t i = 0; i < m_workers.size(); ++i) {
+                threads.emplace_back([this, i] { Work(i); });
+            }
+        }
+
+        std::size_t total = 0;
+        for (const auto& w : m_workers) {
+            total += w->files.size();
+        }
+        std::vector<WalkedFile> results;
+        results.reserve(total);
+        for (auto& w : m_workers) {
+            std::move(w->files.begin(), w->files.end(), std::back_inserter(results));
+        }
+        std::sort(results.begin(), results.end(), ByPath);
+        return results;
+    }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::string> dirs;
+        std::vector<WalkedFile> files;
+    };
+
+    void Push(std::size_t self, std::string dir)
+    {
+        m_pending.fetch_add(1);
+        {
+            std::lock_guard lock(m_workers[self]->mutex);
+            m_workers[self]->dirs.push_back(std::move(dir));
+        }
+        m_wake.fetch_add(1);
+        m_wake.notify_one();
+    }
+
+    bool Pop(std::size_t self, std::string& out)
+    {
+        {
+            auto& own = *m_workers[self];
+            std::lock_guard lock(own.mutex);
+            if (!own.dirs.empty()) {
+                out = std::move(own.dirs.back());
+                own.dirs.pop_back();
+                return true;
+            }
+        }
+        for (std::size_t k = 1; k < m_workers.size(); ++k) {
+            auto& victim = *m_workers[(self + k) % m_workers.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.dirs.empty()) {
+                out = std::move(victim.dirs.front());
+                victim.dirs.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Work(std::size_t self)
+    {
+        std::string dir;
+        while (true) {
+            const auto seen = m_wake.load();
+            if (Pop(self, dir)) {
+                Walk(self, dir);
+                if (m_pending.fetch_sub(1) == 1) {
+                    // Last directory done: release everyone waiting.
+                    m_wake.fetch_add(1);
+                    m_wake.notify_all();
+                    return;
+                }
+                continue;
+            }
+            if (m_pending.load() == 0) {
+                return;
+            }
+            // Nothing to steal yet; sleep until a push or the end of the walk.
+            m_wake.wait(seen);
+        }
+    }
+
+    void Walk(std::size_t self, const std::string& dir)
+    {
+        const int fd = dir.empty() ? ::dup(m_rootFd)
+                                   : ::openat(m_rootFd, dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW);
+        if (fd < 0) {
+            return; // unreadable (or replaced by a symlink meanwhile): skip
+        }
 
-        results.push_back(relStr);
+        const std::string prefix = dir.empty() ? std::string() : dir + '/';
+        auto& files = m_workers[self]->files;
+        ForEachEntry(fd, [&](const char* name, unsigned char type) {
+            switch (Classify(fd, name, type)) {
+            case EntryKind::File: {
+                WalkedFile file{.relativePath = prefix + name, .metadata = {}};
+                struct stat st {};
+                if (m_withMetadata && ::fstatat(fd, name, &st, 0) == 0) {
+                    file.metadata = MetadataFromStat(st);
+                }
+                files.push_back(std::move(file));
+                break;
+            }
+            case EntryKind::Directory:
+                Push(self, prefix + name);
+                break;
+            case EntryKind::Other:
+                break;
+            }
+        });
     }
 
+    int m_rootFd;
+    bool m_withMetadata;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<std::size_t> m_pending{0}; // directories queued or being read
+    std::atomic<std::uint64_t> m_wake{0};  // bumped on every push, waited on when idle
+};
+
+#endif
+
+std::vector<WalkedFile> Walk(fs::path root, const DirWalkOptions& options, bool withMetadata)
+{
+    if (!IsWalkableRoot(root)) {
+        return {};
+    }
+
+#if defined(_WIN32)
+    (void)options;
+    auto results = WalkSequential(std::move(root), withMetadata);
+    std::sort(results.begin(), results.end(), ByPath);
+    return results;
+#else
+    const int rootFd = ::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (rootFd < 0) {
+        return {};
+    }
+
+    std::size_t threads = options.threads;
+    if (threads == 0) {
+        threads = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, kMaxWalkThreads);
+    }
+
+    auto results = ParallelWalker(rootFd, threads, withMetadata).Run();
+    ::close(rootFd);
     return results;
+#endif
+}
+
+} // namespace
+
+bool IsSameFile(const FileMetadata& a, const FileMetadata& b)
+{
+    return a.valid && b.valid && a.inode != 0 && a.inode == b.inode && a.device == b.device;
+}
+
+std::vector<std::string> ListFilesRecursive(fs::path root)
+{
+    return ListFilesRecursive(std::move(root), DirWalkOptions{});
+}
+
+std::vector<std::string> ListFilesRecursive(fs::path root, const DirWalkOptions& options)
+{
+    auto files = Walk(std::move(root), options, false);
+    std::vector<std::string> results;
+    results.reserve(files.size());
+    for (auto& file : files) {
+        results.push_back(std::move(file.relativePath));
+    }
+    return results;
+}
+
+std::vector<WalkedFile> ListFilesWithMetadata(fs::path root, const DirWalkOptions& options)
+{
+    return Walk(std::move(root), options, true);
 }
 
 } // namespace bendiff::core
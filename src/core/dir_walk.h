@@ -1,16 +1,57 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <string>
 #include <vector>
 
 namespace bendiff::core {
 
-// Recursively lists all regular files under `root`.
+struct DirWalkOptions {
+    // Worker threads walking directories in parallel (0 = one per core, up to
+    // a small cap). Trees are split per directory, and idle workers steal
+    // directories still queued by busy ones.
+    std::size_t threads = 0;
+};
+
+// What a stat of a listed file (following symlinks) reported during the walk.
+// `valid` is false if the stat failed. `device` and `inode` are 0 where the
+// platform doesn't expose them (Windows).
+struct FileMetadata {
+    std::uint64_t size = 0;
+    std::int64_t mtimeNs = 0;
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+    bool valid = false;
+};
+
+// True if both stats name the same file (e.g. a symlink and its target).
+bool IsSameFile(const FileMetadata& a, const FileMetadata& b);
+
+struct WalkedFile {
+    std::string relativePath;
+    FileMetadata metadata;
+};
+
+// Recursively lists all regular files under `root`, sorted.
 //
-// - Returns relative paths using '/' separators (via generic_string()).
+// - Returns relative paths using '/' separators, sorted bytewise (the same
+//   order as sorting the strings).
 // - Includes all files (does not ignore .git or any other directories).
-// - Uses error_code-based filesystem APIs to avoid throwing on permission errors.
+// - Symlinks to regular files are listed; symlinked directories are not
+//   descended into.
+// - Unreadable directories are skipped; the walk never throws on permission
+//   errors.
+//
+// On POSIX the walk reads directories through fds opened relative to the
+// root (openat; getdents64 on Linux) and builds relative paths by
+// concatenation, so no per-file path normalization is done.
 std::vector<std::string> ListFilesRecursive(std::filesystem::path root);
+std::vector<std::string> ListFilesRecursive(std::filesystem::path root, const DirWalkOptions& options);
+
+// Same walk and order as ListFilesRecursive(), with each file's metadata. On
+// POSIX this costs one fstatat per file, relative to its directory's fd.
+std::vector<WalkedFile> ListFilesWithMetadata(std::filesystem::path root, const DirWalkOptions& options = {});
 
 } // namespace bendiff::core
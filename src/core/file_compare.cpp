@@ -1,9 +1,9 @@
 #include "file_compare.h"
 
-#include <array>
+#include "mapped_file.h"
+
 #include <cstring>
-#include <fstream>
-#include <system_error>
+#include <vector>
 
 namespace fs = std::filesystem;
 
@@ -11,68 +11,77 @@ namespace bendiff::core {
 
 namespace {
 
-bool get_file_size_if_possible(const fs::path& p, std::uintmax_t& outSize)
-{
-    std::error_code ec;
-    const auto s = fs::file_size(p, ec);
-    if (ec) {
-        return false;
-    }
-    outSize = s;
-    return true;
-}
+constexpr std::size_t kCompareChunk = 256 * 1024;
 
-} // namespace
-
-FileCompareResult CompareFilesBytewise(const fs::path& left, const fs::path& right)
+// The compare behind both entry points. Feeds everything read to the
+// hashers, if given; `bothAtEnd` is set if both files were read to the end.
+FileCompareResult CompareStreams(const fs::path& left,
+                                 const fs::path& right,
+                                 ContentHasher* leftHasher,
+                                 ContentHasher* rightHasher,
+                                 bool& bothAtEnd)
 {
-    std::ifstream a(left, std::ios::binary);
-    std::ifstream b(right, std::ios::binary);
+    bothAtEnd = false;
 
-    if (!a.is_open() || !b.is_open()) {
+    SequentialFile a;
+    SequentialFile b;
+    if (a.Open(left) != FileReadStatus::Ok || b.Open(right) != FileReadStatus::Ok) {
         return FileCompareResult::Unreadable;
     }
 
-    std::uintmax_t sizeA = 0;
-    std::uintmax_t sizeB = 0;
-    const bool gotA = get_file_size_if_possible(left, sizeA);
-    const bool gotB = get_file_size_if_possible(right, sizeB);
-
-    if (gotA && gotB && sizeA != sizeB) {
+    // Regular files of different sizes are never read. Anything else is read
+    // in step from both sides until the first difference; neither file is
+    // mapped, so one truncated meanwhile just compares as shorter.
+    if (a.size() && b.size() && *a.size() != *b.size()) {
         return FileCompareResult::Different;
     }
 
-    std::array<char, 64 * 1024> bufA{};
-    std::array<char, 64 * 1024> bufB{};
-
+    std::vector<char> buffer(2 * kCompareChunk);
+    const std::span<char> chunkA(buffer.data(), kCompareChunk);
+    const std::span<char> chunkB(buffer.data() + kCompareChunk, kCompareChunk);
     while (true) {
-        a.read(bufA.data(), static_cast<std::streamsize>(bufA.size()));
-        b.read(bufB.data(), static_cast<std::streamsize>(bufB.size()));
-
-        const std::streamsize readA = a.gcount();
-        const std::streamsize readB = b.gcount();
-
-        if (a.bad() || b.bad()) {
+        const auto na = a.Read(chunkA);
+        const auto nb = b.Read(chunkB);
+        if (!na || !nb) {
             return FileCompareResult::Unreadable;
         }
-
-        if (readA != readB) {
-            return FileCompareResult::Different;
+        if (leftHasher) {
+            leftHasher->Update(std::string_view(chunkA.data(), *na));
         }
-
-        if (readA == 0) {
-            // Both reached EOF.
-            return FileCompareResult::Same;
+        if (rightHasher) {
+            rightHasher->Update(std::string_view(chunkB.data(), *nb));
         }
-
-        if (std::memcmp(bufA.data(), bufB.data(), static_cast<std::size_t>(readA)) != 0) {
+        bothAtEnd = *na < kCompareChunk && *nb < kCompareChunk;
+        if (*na != *nb || std::memcmp(chunkA.data(), chunkB.data(), *na) != 0) {
             return FileCompareResult::Different;
         }
-
-        if (a.eof() && b.eof()) {
+        if (bothAtEnd) {
             return FileCompareResult::Same;
         }
     }
 }
 
+} // namespace
+
+FileCompareResult CompareFilesBytewise(const fs::path& left, const fs::path& right)
+{
+    bool bothAtEnd = false;
+    return CompareStreams(left, right, nullptr, nullptr, bothAtEnd);
+}
+
+HashedCompareResult CompareAndHashFiles(const fs::path& left, const fs::path& right)
+{
+    ContentHasher leftHasher;
+    ContentHasher rightHasher;
+    bool bothAtEnd = false;
+
+    HashedCompareResult out;
+    out.result = CompareStreams(left, right, &leftHasher, &rightHasher, bothAtEnd);
+    if (bothAtEnd && out.result != FileCompareResult::Unreadable) {
+        out.leftHash = leftHasher.Finish();
+        out.rightHash = rightHasher.Finish();
+    }
+    return out;
+}
+
 } // namespace bendiff::core
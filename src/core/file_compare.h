@@ -1,6 +1,9 @@
 #pragma once
 
+#include <content_hash_cache.h>
+
 #include <filesystem>
+#include <optional>
 
 namespace bendiff::core {
 
@@ -14,8 +17,24 @@ enum class FileCompareResult {
 //
 // - If either file cannot be opened/read => Unreadable
 // - If sizes differ => Different
-// - Otherwise compares contents in chunks => Same/Different
+// - Otherwise compares contents, reading both files in step and stopping at
+//   the first difference => Same/Different
 FileCompareResult CompareFilesBytewise(const std::filesystem::path& left,
                                       const std::filesystem::path& right);
 
+struct HashedCompareResult {
+    FileCompareResult result = FileCompareResult::Unreadable;
+
+    // ContentHash of each side, set only if both files were read to the end:
+    // always for Same, and for Different only when the difference was in
+    // the last chunk read.
+    std::optional<ContentHash> leftHash;
+    std::optional<ContentHash> rightHash;
+};
+
+// CompareFilesBytewise() that also hashes both files in the same pass, so a
+// comparison that reads them whole can seed a ContentHashCache. Still stops
+// at the first difference (and reads nothing when the sizes differ).
+HashedCompareResult CompareAndHashFiles(const std::filesystem::path& left, const std::filesystem::path& right);
+
 } // namespace bendiff::core
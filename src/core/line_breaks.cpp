@@ -0,0 +1,116 @@
+#include "line_breaks.h"
+
+#include <bit>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BENDIFF_LINE_BREAKS_X86 1
+#include <immintrin.h>
+#else
+#define BENDIFF_LINE_BREAKS_X86 0
+#endif
+
+namespace bendiff::core {
+namespace {
+
+void FindLineBreaksScalar(std::string_view text, std::size_t from, std::vector<std::size_t>& out)
+{
+    for (std::size_t i = from; i < text.size(); ++i) {
+        if (text[i] == '\n' || text[i] == '\r') {
+            out.push_back(i);
+        }
+    }
+}
+
+// Appends `base + i` for every set bit i of `mask`, lowest first.
+inline void EmitMask(std::uint32_t mask, std::size_t base, std::vector<std::size_t>& out)
+{
+    while (mask != 0) {
+        out.push_back(base + static_cast<std::size_t>(std::countr_zero(mask)));
+        mask &= mask - 1;
+    }
+}
+
+#if BENDIFF_LINE_BREAKS_X86
+
+__attribute__((target("sse2"))) void FindLineBreaksSse2(std::string_view text, std::vector<std::size_t>& out)
+{
+    constexpr std::size_t kBlock = 16;
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+
+    std::size_t i = 0;
+    for (; i + kBlock <= text.size(); i += kBlock) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i));
+        const __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr));
+        EmitMask(static_cast<std::uint32_t>(_mm_movemask_epi8(hits)), i, out);
+    }
+    FindLineBreaksScalar(text, i, out);
+}
+
+__attribute__((target("avx2"))) void FindLineBreaksAvx2(std::string_view text, std::vector<std::size_t>& out)
+{
+    constexpr std::size_t kBlock = 32;
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+
+    std::size_t i = 0;
+    for (; i + kBlock <= text.size(); i += kBlock) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i));
+        const __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr));
+        EmitMask(static_cast<std::uint32_t>(_mm256_movemask_epi8(hits)), i, out);
+    }
+    FindLineBreaksScalar(text, i, out);
+}
+
+#endif // BENDIFF_LINE_BREAKS_X86
+
+} // namespace
+
+std::vector<LineBreakKernel> AvailableLineBreakKernels()
+{
+    std::vector<LineBreakKernel> out = {LineBreakKernel::Scalar};
+#if BENDIFF_LINE_BREAKS_X86
+    if (__builtin_cpu_supports("sse2")) {
+        out.push_back(LineBreakKernel::Sse2);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        out.push_back(LineBreakKernel::Avx2);
+    }
+#endif
+    return out;
+}
+
+LineBreakKernel BestLineBreakKernel()
+{
+    static const LineBreakKernel best = AvailableLineBreakKernels().back();
+    return best;
+}
+
+void FindLineBreaks(std::string_view text, std::vector<std::size_t>& out)
+{
+    FindLineBreaksWith(BestLineBreakKernel(), text, out);
+}
+
+void FindLineBreaksWith(LineBreakKernel kernel, std::string_view text, std::vector<std::size_t>& out)
+{
+    switch (kernel) {
+    case LineBreakKernel::Scalar:
+        break;
+#if BENDIFF_LINE_BREAKS_X86
+    case LineBreakKernel::Sse2:
+        FindLineBreaksSse2(text, out);
+        return;
+    case LineBreakKernel::Avx2:
+        FindLineBreaksAvx2(text, out);
+        return;
+#else
+    case LineBreakKernel::Sse2:
+    case LineBreakKernel::Avx2:
+        break;
+#endif
+    }
+    FindLineBreaksScalar(text, 0, out);
+}
+
+} // namespace bendiff::core
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace bendiff::core {
+
+// Implementations of FindLineBreaks(). All give the same result; the vector
+// ones compare 16 (Sse2) or 32 (Avx2) bytes per step and turn the matches
+// into offsets with a bit scan, so text is scanned at close to memory speed.
+enum class LineBreakKernel {
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+// Kernels this build and CPU can run, Scalar first and fastest last.
+std::vector<LineBreakKernel> AvailableLineBreakKernels();
+
+// The kernel FindLineBreaks() uses (the last of AvailableLineBreakKernels()).
+LineBreakKernel BestLineBreakKernel();
+
+// Appends the offset of every '\n' and '\r' byte in `text` to `out`, in
+// increasing order. Pairing CRLF is left to the caller.
+void FindLineBreaks(std::string_view text, std::vector<std::size_t>& out);
+
+// Same, with a specific kernel; `kernel` must be available.
+void FindLineBreaksWith(LineBreakKernel kernel, std::string_view text, std::vector<std::size_t>& out);
+
+} // namespace bendiff::core
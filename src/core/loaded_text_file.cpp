@@ -1,134 +1,144 @@
 #include "loaded_text_file.h"
 
-#include <fstream>
+#include "line_breaks.h"
+#include "mapped_file.h"
+#include "utf8_validation.h"
+
+#include <algorithm>
+#include <vector>
 
 namespace fs = std::filesystem;
 
 namespace bendiff::core {
 
-// RFC 3629 style UTF-8 validation.
+// RFC 3629 style UTF-8 validation, with the fastest kernel this CPU supports.
 bool IsValidUtf8(std::string_view bytes)
 {
-    std::size_t i = 0;
-    while (i < bytes.size()) {
-        const unsigned char c = static_cast<unsigned char>(bytes[i]);
+    return IsValidUtf8With(BestUtf8Kernel(), bytes);
+}
 
-        if (c <= 0x7F) {
-            ++i;
-            continue;
+namespace {
+
+// Bytes the load pipeline handles at a time. Each chunk is validated, split
+// and hashed while it is still in cache, so a file's bytes are streamed from
+// memory once however many stages look at them.
+constexpr std::size_t kChunkBytes = 256 * 1024;
+
+// Finds the end of the chunk starting at `begin`: just past its last line
+// break (never between the CR and LF of a CRLF), or the end of the text. A
+// line longer than kChunkBytes makes its chunk longer. Appends the offsets of
+// the chunk's '\n'/'\r' bytes to `breaks`.
+//
+// UTF-8 sequences never contain bytes below 0x80, so a chunk ending at a line
+// break never cuts a sequence and can be validated on its own.
+std::size_t FindChunkEnd(std::string_view text, std::size_t begin, std::vector<std::size_t>& breaks)
+{
+    std::size_t scanned = begin;
+    while (true) {
+        const std::size_t windowEnd = std::min(text.size(), scanned + kChunkBytes);
+        const std::size_t first = breaks.size();
+        FindLineBreaks(text.substr(scanned, windowEnd - scanned), breaks);
+        for (std::size_t k = first; k < breaks.size(); ++k) {
+            breaks[k] += scanned;
         }
 
-        auto is_cont = [&](std::size_t idx) {
-            if (idx >= bytes.size()) {
-                return false;
-            }
-            const unsigned char cc = static_cast<unsigned char>(bytes[idx]);
-            return (cc & 0xC0) == 0x80;
-        };
-
-        if (c >= 0xC2 && c <= 0xDF) {
-            // 2-byte sequence
-            if (!is_cont(i + 1)) {
-                return false;
-            }
-            i += 2;
-            continue;
+        if (windowEnd == text.size()) {
+            return windowEnd;
         }
-
-        if (c == 0xE0) {
-            // 3-byte sequence, special lower bound to avoid overlongs
-            if (!is_cont(i + 1) || !is_cont(i + 2)) {
-                return false;
+        if (!breaks.empty()) {
+            std::size_t end = breaks.back() + 1;
+            if (text[end - 1] == '\r' && text[end] == '\n') {
+                breaks.push_back(end);
+                ++end;
             }
-            const unsigned char c1 = static_cast<unsigned char>(bytes[i + 1]);
-            if (c1 < 0xA0) {
-                return false;
-            }
-            i += 3;
-            continue;
+            return end;
         }
+        scanned = windowEnd;
+    }
+}
 
-        if (c >= 0xE1 && c <= 0xEC) {
-            if (!is_cont(i + 1) || !is_cont(i + 2)) {
-                return false;
-            }
-            i += 3;
-            continue;
-        }
+// Splits `text` per SplitLinesNormalizeNewlines, chunk by chunk. With
+// `validate`, returns false at the first chunk that isn't valid UTF-8. With
+// `hashes`, also records each line's comparison-key hashes.
+bool SplitChunked(std::string_view text, bool validate, diff::LineHashes* hashes, SplitLinesResult& out)
+{
+    if (text.empty()) {
+        return true;
+    }
 
-        if (c == 0xED) {
-            // exclude UTF-16 surrogate halves
-            if (!is_cont(i + 1) || !is_cont(i + 2)) {
-                return false;
-            }
-            const unsigned char c1 = static_cast<unsigned char>(bytes[i + 1]);
-            if (c1 >= 0xA0) {
-                return false;
-            }
-            i += 3;
-            continue;
+    const char last = text.back();
+    out.hadFinalNewline = (last == '\n') || (last == '\r');
+
+    TextLines::Builder lines;
+    lines.Reserve(text.size(), 0);
+
+    std::vector<std::size_t> breaks;
+    std::size_t begin = 0;
+    while (begin < text.size()) {
+        breaks.clear();
+        const std::size_t end = FindChunkEnd(text, begin, breaks);
+
+        if (validate && !IsValidUtf8(text.substr(begin, end - begin))) {
+            return false;
         }
 
-        if (c >= 0xEE && c <= 0xEF) {
-            if (!is_cont(i + 1) || !is_cont(i + 2)) {
-                return false;
+        if (begin == 0 && end < text.size()) {
+            // Size the line index from the first chunk's line density.
+            const std::size_t estimate = breaks.size() * (text.size() / end + 1) + 1;
+            lines.Reserve(text.size(), estimate);
+            if (hashes) {
+                hashes->Reserve(estimate);
             }
-            i += 3;
-            continue;
         }
 
-        if (c == 0xF0) {
-            // 4-byte, special lower bound
-            if (!is_cont(i + 1) || !is_cont(i + 2) || !is_cont(i + 3)) {
-                return false;
+        std::size_t lineStart = begin;
+        auto emit = [&](std::string_view line) {
+            lines.Append(line);
+            if (hashes) {
+                hashes->Append(line);
             }
-            const unsigned char c1 = static_cast<unsigned char>(bytes[i + 1]);
-            if (c1 < 0x90) {
-                return false;
-            }
-            i += 4;
-            continue;
-        }
+        };
+
+        for (std::size_t b = 0; b < breaks.size(); ++b) {
+            const std::size_t pos = breaks[b];
+            emit(text.substr(lineStart, pos - lineStart));
 
-        if (c >= 0xF1 && c <= 0xF3) {
-            if (!is_cont(i + 1) || !is_cont(i + 2) || !is_cont(i + 3)) {
-                return false;
+            // Treat CRLF as a single line break.
+            if (text[pos] == '\r' && b + 1 < breaks.size() && breaks[b + 1] == pos + 1 && text[pos + 1] == '\n') {
+                ++b;
             }
-            i += 4;
-            continue;
+            lineStart = breaks[b] + 1;
         }
 
-        if (c == 0xF4) {
-            // 4-byte, special upper bound (max U+10FFFF)
-            if (!is_cont(i + 1) || !is_cont(i + 2) || !is_cont(i + 3)) {
-                return false;
-            }
-            const unsigned char c1 = static_cast<unsigned char>(bytes[i + 1]);
-            if (c1 > 0x8F) {
-                return false;
-            }
-            i += 4;
-            continue;
+        if (end == text.size() && !out.hadFinalNewline) {
+            // No trailing terminator => keep final partial line (possibly empty).
+            emit(text.substr(lineStart));
         }
 
-        return false;
+        begin = end;
     }
 
+    out.lines = lines.Finish();
     return true;
 }
 
+} // namespace
+
 LoadedTextFile LoadUtf8TextFromBytes(std::string_view bytes, fs::path sourceLabel)
 {
     LoadedTextFile out;
     out.absolutePath = std::move(sourceLabel);
 
-    if (!IsValidUtf8(bytes)) {
+    // One streaming pass: UTF-8 validation, line splitting and key hashing
+    // run chunk by chunk (see SplitChunked).
+    SplitLinesResult split;
+    if (!SplitChunked(bytes, /*validate=*/true, &out.hashes, split)) {
+        out.hashes = {};
         out.status = LoadStatus::NotUtf8;
         return out;
     }
 
-    const auto split = SplitLinesNormalizeNewlines(bytes);
-    out.lines = split.lines;
+    out.lines = std::move(split.lines);
     out.hadFinalNewline = split.hadFinalNewline;
     out.status = LoadStatus::Ok;
     return out;
@@ -137,47 +147,7 @@ LoadedTextFile LoadUtf8TextFromBytes(std::string_view bytes, fs::path sourceLabe
 SplitLinesResult SplitLinesNormalizeNewlines(std::string_view text)
 {
     SplitLinesResult out;
-
-    if (text.empty()) {
-        return out;
-    }
-
-    std::string current;
-    current.reserve(text.size());
-
-    auto flush = [&] {
-        out.lines.push_back(current);
-        current.clear();
-    };
-
-    for (std::size_t i = 0; i < text.size(); ++i) {
-        const char c = text[i];
-
-        if (c == '\n') {
-            flush();
-            continue;
-        }
-
-        if (c == '\r') {
-            // Treat CRLF as a single line break.
-            if (i + 1 < text.size() && text[i + 1] == '\n') {
-                ++i;
-            }
-            flush();
-            continue;
-        }
-
-        current.push_back(c);
-    }
-
-    const char last = text.back();
-    out.hadFinalNewline = (last == '\n') || (last == '\r');
-
-    if (!out.hadFinalNewline) {
-        // No trailing terminator => keep final partial line (possibly empty).
-        out.lines.push_back(current);
-    }
-
+    SplitChunked(text, /*validate=*/false, nullptr, out);
     return out;
 }
 
@@ -186,42 +156,29 @@ LoadedTextFile LoadUtf8TextFile(fs::path absolutePath)
     LoadedTextFile out;
     out.absolutePath = std::move(absolutePath);
     out.status = LoadStatus::Unreadable;
-    out.lines.clear();
+    out.lines = {};
     out.hadFinalNewline = false;
 
-    std::ifstream in(out.absolutePath, std::ios::in | std::ios::binary);
-    if (!in) {
-        std::error_code ec;
-        const bool exists = fs::exists(out.absolutePath, ec);
-
-        // Some libstdc++/libc++ combinations report an error code for a
-        // non-existent path here (instead of ec=0 + exists=false). Treat
-        // ENOENT-style errors as NotFound.
-        if ((!ec && !exists) || ec == std::errc::no_such_file_or_directory) {
-            out.status = LoadStatus::NotFound;
-        } else {
-            out.status = LoadStatus::Unreadable;
-        }
+    // Read rather than mapped: the file may be saved in place while it loads,
+    // and a truncated mapping faults where a read just ends early. The lines
+    // are copied into their own store either way.
+    SequentialFile file;
+    switch (file.Open(out.absolutePath)) {
+    case FileReadStatus::Ok:
+        break;
+    case FileReadStatus::NotFound:
+        out.status = LoadStatus::NotFound;
         return out;
-    }
-
-    std::string bytes;
-    in.seekg(0, std::ios::end);
-    if (in.good()) {
-        const auto endPos = in.tellg();
-        if (endPos > 0) {
-            bytes.reserve(static_cast<std::size_t>(endPos));
-        }
-    }
-    in.seekg(0, std::ios::beg);
-
-    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
-    if (!in.good() && !in.eof()) {
+    case FileReadStatus::Unreadable:
         out.status = LoadStatus::Unreadable;
         return out;
     }
 
-    return LoadUtf8TextFromBytes(bytes, out.absolutePath);
+    const auto bytes = file.ReadAll();
+    if (!bytes) {
+        return out;
+    }
+    return LoadUtf8TextFromBytes(*bytes, out.absolutePath);
 }
 
 } // namespace bendiff::core
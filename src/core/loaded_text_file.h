@@ -1,5 +1,8 @@
 #pragma once
 
+#include <diff/line_hashes.h>
+#include <text_lines.h>
+
 #include <filesystem>
 #include <string>
 #include <string_view>
@@ -17,12 +20,17 @@ enum class LoadStatus {
 struct LoadedTextFile {
     std::filesystem::path absolutePath;
     LoadStatus status = LoadStatus::Ok;
-    std::vector<std::string> lines;
+    TextLines lines;
     bool hadFinalNewline = false;
+
+    // Comparison-key hashes of `lines` under every whitespace mode, computed
+    // while loading (see DiffLines for LoadedTextFile). Empty for files whose
+    // lines were filled in directly.
+    diff::LineHashes hashes;
 };
 
 struct SplitLinesResult {
-    std::vector<std::string> lines;
+    TextLines lines;
     bool hadFinalNewline = false;
 };
 
@@ -41,6 +49,8 @@ bool IsValidUtf8(std::string_view bytes);
 //
 // - If bytes are invalid UTF-8: status=NotUtf8
 // - Otherwise: status=Ok and newline normalization is applied.
+//
+// Validation, splitting and hashing share one pass over `bytes`.
 LoadedTextFile LoadUtf8TextFromBytes(std::string_view bytes, std::filesystem::path sourceLabel);
 
 inline bool IsUnsupportedText(const LoadedTextFile& f)
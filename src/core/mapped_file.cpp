@@ -0,0 +1,257 @@
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <utility>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <system_error>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace bendiff::core {
+namespace {
+
+constexpr std::size_t kReadChunk = 64 * 1024;
+
+#if !defined(_WIN32)
+
+// Reads `fd` to EOF into `out`. Used for files that can't be mapped.
+bool ReadAll(int fd, std::string& out)
+{
+    std::array<char, kReadChunk> chunk{};
+    while (true) {
+        const ssize_t n = ::read(fd, chunk.data(), chunk.size());
+        if (n == 0) {
+            return true;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        out.append(chunk.data(), static_cast<std::size_t>(n));
+    }
+}
+
+#endif
+
+} // namespace
+
+MappedFile::~MappedFile()
+{
+    Reset();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this == &other) {
+        return *this;
+    }
+
+    Reset();
+    m_mapped = std::exchange(other.m_mapped, false);
+    m_size = std::exchange(other.m_size, 0);
+    m_buffer = std::move(other.m_buffer);
+    other.m_buffer.clear();
+    // An owned buffer may have moved (small-string storage), so re-point.
+    m_data = m_mapped ? other.m_data : m_buffer.data();
+    other.m_data = nullptr;
+    return *this;
+}
+
+void MappedFile::Reset()
+{
+#if !defined(_WIN32)
+    if (m_mapped) {
+        ::munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_buffer.clear();
+}
+
+FileReadStatus MappedFile::Open(const fs::path& path)
+{
+    Reset();
+
+#if defined(_WIN32)
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in) {
+        std::error_code ec;
+        const bool exists = fs::exists(path, ec);
+        return (!ec && !exists) ? FileReadStatus::NotFound : FileReadStatus::Unreadable;
+    }
+
+    std::array<char, kReadChunk> chunk{};
+    while (in.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) || in.gcount() > 0) {
+        m_buffer.append(chunk.data(), static_cast<std::size_t>(in.gcount()));
+    }
+    if (in.bad()) {
+        Reset();
+        return FileReadStatus::Unreadable;
+    }
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno == ENOENT ? FileReadStatus::NotFound : FileReadStatus::Unreadable;
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || S_ISDIR(st.st_mode)) {
+        ::close(fd);
+        return FileReadStatus::Unreadable;
+    }
+
+    if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        const auto size = static_cast<std::size_t>(st.st_size);
+        void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            ::madvise(p, size, MADV_SEQUENTIAL);
+            ::close(fd);
+            m_data = static_cast<const char*>(p);
+            m_size = size;
+            m_mapped = true;
+            return FileReadStatus::Ok;
+        }
+    }
+
+    // Pipes, devices and procfs entries (which report a size of 0) are read
+    // to EOF instead; so is anything mmap refused.
+    const bool ok = ReadAll(fd, m_buffer);
+    ::close(fd);
+    if (!ok) {
+        Reset();
+        return FileReadStatus::Unreadable;
+    }
+#endif
+
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return FileReadStatus::Ok;
+}
+
+SequentialFile::~SequentialFile()
+{
+    Close();
+}
+
+void SequentialFile::Close()
+{
+#if defined(_WIN32)
+    m_in.close();
+#else
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    m_size.reset();
+}
+
+FileReadStatus SequentialFile::Open(const fs::path& path)
+{
+    Close();
+
+#if defined(_WIN32)
+    m_in.open(path, std::ios::in | std::ios::binary);
+    if (!m_in) {
+        std::error_code ec;
+        const bool exists = fs::exists(path, ec);
+        return (!ec && !exists) ? FileReadStatus::NotFound : FileReadStatus::Unreadable;
+    }
+    std::error_code ec;
+    if (fs::is_regular_file(path, ec)) {
+        const auto size = fs::file_size(path, ec);
+        if (!ec && size > 0) {
+            m_size = static_cast<std::uint64_t>(size);
+        }
+    }
+#else
+    m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0) {
+        return errno == ENOENT ? FileReadStatus::NotFound : FileReadStatus::Unreadable;
+    }
+
+    struct stat st {};
+    if (::fstat(m_fd, &st) != 0 || S_ISDIR(st.st_mode)) {
+        Close();
+        return FileReadStatus::Unreadable;
+    }
+    if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        m_size = static_cast<std::uint64_t>(st.st_size);
+    }
+#if defined(__linux__)
+    ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#endif
+    return FileReadStatus::Ok;
+}
+
+std::optional<std::size_t> SequentialFile::Read(std::span<char> buffer)
+{
+#if defined(_WIN32)
+    m_in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (m_in.bad()) {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(m_in.gcount());
+#else
+    std::size_t filled = 0;
+    while (filled < buffer.size()) {
+        const ssize_t n = ::read(m_fd, buffer.data() + filled, buffer.size() - filled);
+        if (n == 0) {
+            break;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return std::nullopt;
+        }
+        filled += static_cast<std::size_t>(n);
+    }
+    return filled;
+#endif
+}
+
+std::optional<std::string> SequentialFile::ReadAll()
+{
+    constexpr std::size_t kMinStep = 256 * 1024;
+
+    // One byte past the reported size, so a file that hasn't grown since
+    // Open() is read, and its end seen, with a single allocation.
+    std::size_t step = m_size ? static_cast<std::size_t>(*m_size) + 1 : kMinStep;
+    std::string bytes;
+    while (true) {
+        const std::size_t filled = bytes.size();
+        bytes.resize(filled + step);
+        const auto n = Read(std::span<char>(bytes.data() + filled, step));
+        if (!n) {
+            return std::nullopt;
+        }
+        bytes.resize(filled + *n);
+        if (*n < step) {
+            return bytes;
+        }
+        step = std::max(kMinStep, bytes.size());
+    }
+}
+
+} // namespace bendiff::core
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#if defined(_WIN32)
+#include <fstream>
+#endif
+
+namespace bendiff::core {
+
+enum class FileReadStatus {
+    Ok,
+    NotFound,
+    Unreadable,
+};
+
+// Read-only access to a whole file's bytes.
+//
+// Regular files are memory-mapped (POSIX; advised for sequential access), so
+// their bytes are read straight from the page cache without being copied into
+// a user-space buffer. Anything that can't be
+// mapped (pipes, character devices, procfs entries, non-POSIX platforms) is
+// read into an owned buffer instead; callers see the same bytes() either way.
+//
+// The file must not be truncated while mapped: like every mmap reader, a
+// concurrent truncation can fault on access (SIGBUS). Readers of files that
+// may change underneath them, such as the text loader and the folder compare,
+// use SequentialFile instead.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Replaces any previous contents. On failure bytes() is empty.
+    FileReadStatus Open(const std::filesystem::path& path);
+
+    std::string_view bytes() const { return {m_data, m_size}; }
+
+    // True if bytes() points into a mapping rather than an owned buffer.
+    bool isMapped() const { return m_mapped; }
+
+private:
+    void Reset();
+
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_mapped = false;
+    std::string m_buffer; // fallback storage when not mapped
+};
+
+// Front-to-back reads of a file into caller buffers (read(2) on POSIX).
+//
+// For one-pass readers that gain little from a mapping, such as the folder
+// compare and the text loader: a file truncated while it is being read just
+// ends early, where a mapping would fault.
+class SequentialFile {
+public:
+    SequentialFile() = default;
+    ~SequentialFile();
+
+    SequentialFile(const SequentialFile&) = delete;
+    SequentialFile& operator=(const SequentialFile&) = delete;
+
+    FileReadStatus Open(const std::filesystem::path& path);
+
+    // Size reported when opened, for regular files with a non-zero size
+    // (pipes, devices and procfs entries have no useful size).
+    std::optional<std::uint64_t> size() const { return m_size; }
+
+    // Fills `buffer` as far as the file allows; returns the bytes read (fewer
+    // only at end of file), or nullopt on a read error.
+    std::optional<std::size_t> Read(std::span<char> buffer);
+
+    // Reads the rest of the file into one owned buffer, sized from size()
+    // when known; nullopt on a read error.
+    std::optional<std::string> ReadAll();
+
+private:
+    void Close();
+
+#if defined(_WIN32)
+    std::ifstream m_in;
+#else
+    int m_fd = -1;
+#endif
+    std::optional<std::uint64_t> m_size;
+};
+
+} // namespace bendiff::core
@@ -1,5 +1,7 @@
 #include "change_navigation.h"
 
+#include <algorithm>
+
 namespace bendiff::core::navigation {
 
 std::vector<ChangeLocation> EnumerateChangeHunks(const diff::DiffResult& d)
@@ -21,6 +23,104 @@ std::vector<ChangeLocation> EnumerateChangeHunks(const diff::DiffResult& d)
     return out;
 }
 
+namespace {
+
+// Index of the first hunk starting after `row`.
+std::size_t FirstStartingAfter(std::span<const HunkRows> hunks, std::size_t row)
+{
+    const auto it = std::partition_point(hunks.begin(), hunks.end(), [row](const HunkRows& h) {
+        return h.firstRow <= row;
+    });
+    return static_cast<std::size_t>(it - hunks.begin());
+}
+
+// The hunk Next/Prev step from: `current` while its first row is on screen,
+// else the hunk showing the first visible row.
+std::optional<std::size_t> StepOrigin(std::span<const HunkRows> hunks,
+                                      std::optional<std::size_t> current,
+                                      VisibleRows view)
+{
+    if (current.has_value() && *current < hunks.size()) {
+        const std::size_t first = hunks[*current].firstRow;
+        if (first >= view.firstRow && first - view.firstRow < view.rowCount) {
+            return current;
+        }
+    }
+    return HunkAtRow(hunks, view.firstRow);
+}
+
+} // namespace
+
+std::optional<std::size_t> FirstRowOfHunk(std::span<const HunkRows> hunks, std::size_t hunkIndex)
+{
+    if (hunkIndex >= hunks.size()) {
+        return std::nullopt;
+    }
+    return hunks[hunkIndex].firstRow;
+}
+
+std::optional<std::size_t> HunkAtRow(std::span<const HunkRows> hunks, std::size_t row)
+{
+    const std::size_t after = FirstStartingAfter(hunks, row);
+    if (after == 0) {
+        return std::nullopt;
+    }
+    const auto& h = hunks[after - 1];
+    if (row >= h.firstRow + h.rowCount) {
+        return std::nullopt;
+    }
+    return after - 1;
+}
+
+std::optional<std::size_t> NextHunkAfterRow(std::span<const HunkRows> hunks, std::size_t row)
+{
+    const std::size_t after = FirstStartingAfter(hunks, row);
+    if (after >= hunks.size()) {
+        return std::nullopt;
+    }
+    return after;
+}
+
+std::optional<std::size_t> PrevHunkBeforeRow(std::span<const HunkRows> hunks, std::size_t row)
+{
+    // First hunk starting at or after `row`; the one before it starts before.
+    const auto it = std::partition_point(hunks.begin(), hunks.end(), [row](const HunkRows& h) {
+        return h.firstRow < row;
+    });
+    if (it == hunks.begin()) {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(it - hunks.begin()) - 1;
+}
+
+std::optional<std::size_t> NextHunkFromView(std::span<const HunkRows> hunks,
+                                            std::optional<std::size_t> current,
+                                            VisibleRows view)
+{
+    if (hunks.empty()) {
+        return std::nullopt;
+    }
+
+    if (const auto origin = StepOrigin(hunks, current, view)) {
+        return *origin + 1 < hunks.size() ? *origin + 1 : 0;
+    }
+    return NextHunkAfterRow(hunks, view.firstRow).value_or(0);
+}
+
+std::optional<std::size_t> PrevHunkFromView(std::span<const HunkRows> hunks,
+                                            std::optional<std::size_t> current,
+                                            VisibleRows view)
+{
+    if (hunks.empty()) {
+        return std::nullopt;
+    }
+
+    if (const auto origin = StepOrigin(hunks, current, view)) {
+        return *origin > 0 ? *origin - 1 : hunks.size() - 1;
+    }
+    return PrevHunkBeforeRow(hunks, view.firstRow).value_or(hunks.size() - 1);
+}
+
 std::optional<std::size_t> NextChangeIndex(std::optional<std::size_t> currentIndex,
                                           std::span<const ChangeLocation> changes)
 {
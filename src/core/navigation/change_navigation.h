@@ -23,6 +23,45 @@ struct ChangeLocation {
 
 std::vector<ChangeLocation> EnumerateChangeHunks(const diff::DiffResult& d);
 
+// Visual rows of one hunk: [firstRow, firstRow + rowCount). The render
+// builders emit one per DiffHunk, in hunk order (RenderDocument::hunkRows);
+// since hunks never share rows, first rows increase strictly with the hunk
+// index, and the lookups below are binary searches.
+struct HunkRows {
+    std::size_t firstRow = 0;
+    std::size_t rowCount = 0;
+};
+
+// First visual row of hunk `hunkIndex`, or nullopt if out of range.
+std::optional<std::size_t> FirstRowOfHunk(std::span<const HunkRows> hunks, std::size_t hunkIndex);
+
+// The hunk showing visual row `row`, or nullopt if the row is unchanged.
+std::optional<std::size_t> HunkAtRow(std::span<const HunkRows> hunks, std::size_t row);
+
+// The first hunk starting after `row` / the last hunk starting before it
+// (nullopt if none), for navigating from a position rather than a hunk.
+std::optional<std::size_t> NextHunkAfterRow(std::span<const HunkRows> hunks, std::size_t row);
+std::optional<std::size_t> PrevHunkBeforeRow(std::span<const HunkRows> hunks, std::size_t row);
+
+// Rows a pane shows: [firstRow, firstRow + rowCount).
+struct VisibleRows {
+    std::size_t firstRow = 0;
+    std::size_t rowCount = 0;
+};
+
+// The hunk Next / Previous Change moves to from a pane showing `view`, where
+// `current` is the hunk last moved to. While `current` starts on screen the
+// step is from it; once the view has been scrolled away, it is from the hunk
+// showing the first visible row, or else to the first hunk starting after /
+// the last hunk starting before that row. Wraps around at either end;
+// nullopt only if there are no hunks.
+std::optional<std::size_t> NextHunkFromView(std::span<const HunkRows> hunks,
+                                            std::optional<std::size_t> current,
+                                            VisibleRows view);
+std::optional<std::size_t> PrevHunkFromView(std::span<const HunkRows> hunks,
+                                            std::optional<std::size_t> current,
+                                            VisibleRows view);
+
 // Returns the index into the `changes` vector.
 std::optional<std::size_t> NextChangeIndex(std::optional<std::size_t> currentIndex,
                                           std::span<const ChangeLocation> changes);
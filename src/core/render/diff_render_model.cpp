@@ -5,9 +5,7 @@
 namespace bendiff::core::render {
 namespace {
 
-RenderLine MakeLineFromRow(const LoadedTextFile& left,
-                           const LoadedTextFile& right,
-                           const diff::AlignedRow& row)
+RenderLine MakeLineFromRow(const TextLines& left, const TextLines& right, const diff::AlignedRow& row)
 {
     RenderLine out;
     out.op = row.op;
@@ -15,22 +13,33 @@ RenderLine MakeLineFromRow(const LoadedTextFile& left,
     if (row.left) {
         const auto idx = *row.left;
         out.leftLine = idx + 1;
-        if (idx < left.lines.size()) {
-            out.leftText = left.lines[idx];
+        if (idx < left.size()) {
+            out.leftText = left[idx];
         }
     }
 
     if (row.right) {
         const auto idx = *row.right;
         out.rightLine = idx + 1;
-        if (idx < right.lines.size()) {
-            out.rightText = right.lines[idx];
+        if (idx < right.size()) {
+            out.rightText = right[idx];
         }
     }
 
     return out;
 }
 
+// Rows of a document showing a single file: all deleted or all inserted.
+diff::AlignedRowView WholeFileRows(std::size_t lineCount, diff::LineOp op)
+{
+    if (lineCount == 0) {
+        return diff::AlignedRowView(std::vector<diff::AlignedRun>{});
+    }
+    return diff::AlignedRowView(std::vector<diff::AlignedRun>{
+        diff::AlignedRun{.op = op, .leftStart = 0, .rightStart = 0, .length = lineCount},
+    });
+}
+
 void PushLine(RenderDocument& doc, RenderBlockSide side, RenderLine line)
 {
     if (doc.blocks.empty() || doc.blocks.back().side != side) {
@@ -42,13 +51,105 @@ void PushLine(RenderDocument& doc, RenderBlockSide side, RenderLine line)
     doc.blocks.back().lines.push_back(std::move(line));
 }
 
+// Extends the last change run with rows [row, row + count) or starts a new
+// one. Rows must be noted in increasing order.
+void NoteRows(RenderDocument& doc, std::size_t row, std::size_t count, diff::LineOp op)
+{
+    if (op == diff::LineOp::Equal || count == 0) {
+        return;
+    }
+
+    if (!doc.changeRuns.empty()) {
+        auto& last = doc.changeRuns.back();
+        if (last.op == op && last.firstRow + last.rowCount == row) {
+            last.rowCount += count;
+            return;
+        }
+    }
+    doc.changeRuns.push_back(RenderRowRun{.firstRow = row, .rowCount = count, .op = op});
+}
+
+// One entry per hunk of `d`. A hunk's first row is the number of left lines
+// before it (equal or deleted) plus the right lines inserted before it.
+std::vector<navigation::HunkRows> IndexHunkRows(const diff::DiffResult& d)
+{
+    std::vector<navigation::HunkRows> out;
+    out.reserve(d.hunks.size());
+
+    std::size_t insertedBefore = 0;
+    for (const auto& h : d.hunks) {
+        out.push_back(navigation::HunkRows{
+            .firstRow = h.leftStart + insertedBefore,
+            .rowCount = h.leftCount + h.rightCount,
+        });
+        insertedBefore += h.rightCount;
+    }
+    return out;
+}
+
+// Rows built between stop polls and progress reports.
+constexpr std::size_t kControlInterval = 4096;
+
+// Called before building row `done` of `total`. Returns false if the build
+// should stop.
+bool CheckIn(const WorkControl& control, std::size_t done, std::size_t total)
+{
+    if (done % kControlInterval != 0) {
+        return true;
+    }
+    if (control.StopRequested()) {
+        return false;
+    }
+    control.ReportProgress(static_cast<double>(done) / static_cast<double>(total));
+    return true;
+}
+
+// Widest line of `lines`, in DisplayColumns(). A line is no wider than its
+// byte count unless it has tabs, so most lines are skipped without a scan.
+std::size_t WidestLine(const TextLines& lines)
+{
+    std::size_t widest = 0;
+    for (const auto line : lines) {
+        if (line.size() <= widest
+            && (line.size() * kTabStopColumns <= widest || line.find('\t') == std::string_view::npos)) {
+            continue;
+        }
+        widest = std::max(widest, DisplayColumns(line));
+    }
+    return widest;
+}
+
+void SetLines(RenderDocument& doc, const LoadedTextFile& left, const LoadedTextFile& right)
+{
+    doc.leftLines = left.lines;
+    doc.rightLines = right.lines;
+    doc.leftColumns = WidestLine(left.lines);
+    doc.rightColumns = WidestLine(right.lines);
+}
+
+RenderDocument Cancelled()
+{
+    RenderDocument doc;
+    doc.cancelled = true;
+    return doc;
+}
+
 } // namespace
 
 RenderDocument BuildSideBySideRender(const LoadedTextFile& left,
                                     const LoadedTextFile& right,
                                     const diff::DiffResult& d)
+{
+    return BuildSideBySideRender(left, right, d, WorkControl{});
+}
+
+RenderDocument BuildSideBySideRender(const LoadedTextFile& left,
+                                    const LoadedTextFile& right,
+                                    const diff::DiffResult& d,
+                                    const WorkControl& control)
 {
     RenderDocument doc;
+    SetLines(doc, left, right);
 
     // Deleted/added file semantics:
     // - If only left is loaded: treat as all-Delete.
@@ -59,16 +160,21 @@ RenderDocument BuildSideBySideRender(const LoadedTextFile& left,
         block.lines.reserve(left.lines.size());
 
         for (std::size_t i = 0; i < left.lines.size(); ++i) {
+            if (!CheckIn(control, i, left.lines.size())) {
+                return Cancelled();
+            }
             RenderLine line;
             line.op = diff::LineOp::Delete;
             line.leftLine = i + 1;
             line.rightLine.reset();
             line.leftText = left.lines[i];
-            line.rightText.clear();
             block.lines.push_back(std::move(line));
         }
 
         doc.blocks.push_back(std::move(block));
+        doc.rows = WholeFileRows(left.lines.size(), diff::LineOp::Delete);
+        doc.hunkRows = IndexHunkRows(d);
+        NoteRows(doc, 0, left.lines.size(), diff::LineOp::Delete);
         return doc;
     }
 
@@ -78,16 +184,21 @@ RenderDocument BuildSideBySideRender(const LoadedTextFile& left,
         block.lines.reserve(right.lines.size());
 
         for (std::size_t i = 0; i < right.lines.size(); ++i) {
+            if (!CheckIn(control, i, right.lines.size())) {
+                return Cancelled();
+            }
             RenderLine line;
             line.op = diff::LineOp::Insert;
             line.leftLine.reset();
             line.rightLine = i + 1;
-            line.leftText.clear();
             line.rightText = right.lines[i];
             block.lines.push_back(std::move(line));
         }
 
         doc.blocks.push_back(std::move(block));
+        doc.rows = WholeFileRows(right.lines.size(), diff::LineOp::Insert);
+        doc.hunkRows = IndexHunkRows(d);
+        NoteRows(doc, 0, right.lines.size(), diff::LineOp::Insert);
         return doc;
     }
 
@@ -95,25 +206,45 @@ RenderDocument BuildSideBySideRender(const LoadedTextFile& left,
         return doc;
     }
 
-    const auto rows = diff::BuildAlignedRows(d);
+    doc.rows = diff::AlignedRowView(d);
+    doc.hunkRows = IndexHunkRows(d);
+    const auto runs = doc.rows.runs();
+    const std::size_t rowCount = doc.rows.rowCount();
 
     RenderBlock block;
     block.side = RenderBlockSide::Both;
-    block.lines.reserve(rows.size());
-
-    for (const auto& row : rows) {
-        block.lines.push_back(MakeLineFromRow(left, right, row));
+    block.lines.reserve(rowCount);
+
+    std::size_t i = 0;
+    for (const auto& run : runs) {
+        NoteRows(doc, i, run.length, run.op);
+        for (std::size_t k = 0; k < run.length; ++k, ++i) {
+            if (!CheckIn(control, i, rowCount)) {
+                return Cancelled();
+            }
+            block.lines.push_back(MakeLineFromRow(left.lines, right.lines, diff::RowInRun(run, k)));
+        }
     }
 
     doc.blocks.push_back(std::move(block));
+    control.ReportProgress(1.0);
     return doc;
 }
 
 RenderDocument BuildInlineRender(const LoadedTextFile& left,
                                 const LoadedTextFile& right,
                                 const diff::DiffResult& d)
+{
+    return BuildInlineRender(left, right, d, WorkControl{});
+}
+
+RenderDocument BuildInlineRender(const LoadedTextFile& left,
+                                const LoadedTextFile& right,
+                                const diff::DiffResult& d,
+                                const WorkControl& control)
 {
     RenderDocument doc;
+    SetLines(doc, left, right);
 
     // Deleted/added file semantics for inline mode:
     // - If only left is loaded: one big Left (deletion) block.
@@ -124,16 +255,21 @@ RenderDocument BuildInlineRender(const LoadedTextFile& left,
         block.lines.reserve(left.lines.size());
 
         for (std::size_t i = 0; i < left.lines.size(); ++i) {
+            if (!CheckIn(control, i, left.lines.size())) {
+                return Cancelled();
+            }
             RenderLine line;
             line.op = diff::LineOp::Delete;
             line.leftLine = i + 1;
             line.rightLine.reset();
             line.leftText = left.lines[i];
-            line.rightText.clear();
             block.lines.push_back(std::move(line));
         }
 
         doc.blocks.push_back(std::move(block));
+        doc.rows = WholeFileRows(left.lines.size(), diff::LineOp::Delete);
+        doc.hunkRows = IndexHunkRows(d);
+        NoteRows(doc, 0, left.lines.size(), diff::LineOp::Delete);
         return doc;
     }
 
@@ -143,16 +279,21 @@ RenderDocument BuildInlineRender(const LoadedTextFile& left,
         block.lines.reserve(right.lines.size());
 
         for (std::size_t i = 0; i < right.lines.size(); ++i) {
+            if (!CheckIn(control, i, right.lines.size())) {
+                return Cancelled();
+            }
             RenderLine line;
             line.op = diff::LineOp::Insert;
             line.leftLine.reset();
             line.rightLine = i + 1;
-            line.leftText.clear();
             line.rightText = right.lines[i];
             block.lines.push_back(std::move(line));
         }
 
         doc.blocks.push_back(std::move(block));
+        doc.rows = WholeFileRows(right.lines.size(), diff::LineOp::Insert);
+        doc.hunkRows = IndexHunkRows(d);
+        NoteRows(doc, 0, right.lines.size(), diff::LineOp::Insert);
         return doc;
     }
 
@@ -160,25 +301,83 @@ RenderDocument BuildInlineRender(const LoadedTextFile& left,
         return doc;
     }
 
-    const auto rows = diff::BuildAlignedRows(d);
+    doc.rows = diff::AlignedRowView(d);
+    doc.hunkRows = IndexHunkRows(d);
+    const auto runs = doc.rows.runs();
+    const std::size_t rowCount = doc.rows.rowCount();
 
-    for (const auto& row : rows) {
-        const auto line = MakeLineFromRow(left, right, row);
+    std::size_t i = 0;
+    for (const auto& run : runs) {
+        NoteRows(doc, i, run.length, run.op);
 
-        switch (row.op) {
+        RenderBlockSide side = RenderBlockSide::Both;
+        switch (run.op) {
             case diff::LineOp::Equal:
-                PushLine(doc, RenderBlockSide::Both, line);
+                side = RenderBlockSide::Both;
                 break;
             case diff::LineOp::Delete:
-                PushLine(doc, RenderBlockSide::Left, line);
+                side = RenderBlockSide::Left;
                 break;
             case diff::LineOp::Insert:
-                PushLine(doc, RenderBlockSide::Right, line);
+                side = RenderBlockSide::Right;
                 break;
         }
+
+        for (std::size_t k = 0; k < run.length; ++k, ++i) {
+            if (!CheckIn(control, i, rowCount)) {
+                return Cancelled();
+            }
+            PushLine(doc, side, MakeLineFromRow(left.lines, right.lines, diff::RowInRun(run, k)));
+        }
+    }
+
+    control.ReportProgress(1.0);
+    return doc;
+}
+
+RenderDocument BuildLazyRender(const LoadedTextFile& left,
+                               const LoadedTextFile& right,
+                               const diff::DiffResult& d)
+{
+    RenderDocument doc;
+    SetLines(doc, left, right);
+
+    if (left.status != LoadStatus::Ok && right.status != LoadStatus::Ok) {
+        return doc;
+    }
+
+    if (right.status != LoadStatus::Ok) {
+        doc.rows = WholeFileRows(left.lines.size(), diff::LineOp::Delete);
+    } else if (left.status != LoadStatus::Ok) {
+        doc.rows = WholeFileRows(right.lines.size(), diff::LineOp::Insert);
+    } else {
+        doc.rows = diff::AlignedRowView(d);
     }
+    doc.hunkRows = IndexHunkRows(d);
 
+    const auto runs = doc.rows.runs();
+    for (std::size_t i = 0; i < runs.size(); ++i) {
+        NoteRows(doc, doc.rows.runStart(i), runs[i].length, runs[i].op);
+    }
     return doc;
 }
 
+RenderLine RenderRowAt(const RenderDocument& doc, std::size_t row)
+{
+    return MakeLineFromRow(doc.leftLines, doc.rightLines, doc.rows.row(row));
+}
+
+std::size_t DisplayColumns(std::string_view text, std::size_t tabStop)
+{
+    std::size_t columns = 0;
+    for (const char c : text) {
+        if (c == '\t') {
+            columns += tabStop - columns % tabStop;
+        } else if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) {
+            ++columns;
+        }
+    }
+    return columns;
+}
+
 } // namespace bendiff::core::render
@@ -3,10 +3,13 @@
 #include <diff/alignment.h>
 #include <diff/diff.h>
 #include <loaded_text_file.h>
+#include <navigation/change_navigation.h>
+#include <text_lines.h>
+#include <work_control.h>
 
 #include <cstddef>
 #include <optional>
-#include <string>
+#include <string_view>
 #include <vector>
 
 namespace bendiff::core::render {
@@ -23,9 +26,10 @@ struct RenderLine {
 
     diff::LineOp op = diff::LineOp::Equal;
 
-    // Text for each side (empty if not present).
-    std::string leftText;
-    std::string rightText;
+    // Text for each side (empty if not present). Views into the owning
+    // RenderDocument's leftLines/rightLines.
+    std::string_view leftText;
+    std::string_view rightText;
 };
 
 struct RenderBlock {
@@ -33,8 +37,45 @@ struct RenderBlock {
     std::vector<RenderLine> lines;
 };
 
+// A maximal run of consecutive changed rows with the same op. Rows are
+// numbered across blocks, in display order.
+struct RenderRowRun {
+    std::size_t firstRow = 0;
+    std::size_t rowCount = 0;
+    diff::LineOp op = diff::LineOp::Insert;
+};
+
 struct RenderDocument {
     std::vector<RenderBlock> blocks;
+
+    // Every row of the document (across blocks, in display order) as aligned
+    // runs; RenderRowAt() turns one into a RenderLine. Documents from
+    // BuildLazyRender() have no blocks and are read through this alone.
+    diff::AlignedRowView rows;
+
+    // The line stores RenderLine texts point into (shared with the
+    // LoadedTextFiles the document was built from).
+    TextLines leftLines;
+    TextLines rightLines;
+
+    // Widest line of each store, in DisplayColumns(), measured by the
+    // builders so views can size their scroll range without a pass over
+    // every line.
+    std::size_t leftColumns = 0;
+    std::size_t rightColumns = 0;
+
+    // Changed rows as runs, in row order (filled in by the builders). Lets
+    // views highlight and look up changes per run instead of per row.
+    std::vector<RenderRowRun> changeRuns;
+
+    // The rows of each hunk of the DiffResult the document was built from,
+    // in hunk order, for O(log hunks) navigation (see HunkAtRow() and
+    // friends in change_navigation.h).
+    std::vector<navigation::HunkRows> hunkRows;
+
+    // True if the builder's WorkControl requested a stop; `blocks` is then
+    // empty and the document must not be displayed.
+    bool cancelled = false;
 };
 
 RenderDocument BuildSideBySideRender(const LoadedTextFile& left,
@@ -45,6 +86,38 @@ RenderDocument BuildInlineRender(const LoadedTextFile& left,
                                 const LoadedTextFile& right,
                                 const diff::DiffResult& d);
 
+// Cancellable variants: poll `control` every few thousand rows and report the
+// fraction of rows built.
+RenderDocument BuildSideBySideRender(const LoadedTextFile& left,
+                                    const LoadedTextFile& right,
+                                    const diff::DiffResult& d,
+                                    const WorkControl& control);
+
+RenderDocument BuildInlineRender(const LoadedTextFile& left,
+                                const LoadedTextFile& right,
+                                const diff::DiffResult& d,
+                                const WorkControl& control);
+
+// Lazy variant for large diffs: fills in `rows`, `changeRuns` and the line
+// stores but builds no blocks, in O(hunks) memory whatever the file sizes
+// (plus one scan of the lines for the column widths). The same document serves both inline and side-by-side views, which
+// fetch only the rows they show with RenderRowAt().
+RenderDocument BuildLazyRender(const LoadedTextFile& left,
+                               const LoadedTextFile& right,
+                               const diff::DiffResult& d);
+
+// Row `row` (< doc.rows.rowCount()) of `doc`, built on demand. Same content
+// as the row in the document's blocks, if it has them.
+RenderLine RenderRowAt(const RenderDocument& doc, std::size_t row);
+
+// Tab stops every this many columns, as the diff panes draw them.
+constexpr std::size_t kTabStopColumns = 8;
+
+// Columns `text` takes in a monospace pane: one per code point (UTF-8 lead
+// byte), with each tab advancing to the next multiple of `tabStop`. Used to
+// size the horizontal scroll range to what is actually drawn.
+std::size_t DisplayColumns(std::string_view text, std::size_t tabStop = kTabStopColumns);
+
 // Inline policy (v1): Equal lines are emitted as neutral "Both" blocks.
 // Delete lines are emitted as "Left" blocks; Insert lines as "Right" blocks.
 
@@ -11,10 +11,10 @@ DiffRenderModel BuildDeletedFileRenderModel(const LoadedTextFile& committed, Dif
     auto make_deleted_lines = [&] {
         std::vector<RenderLine> lines;
         lines.reserve(committed.lines.size());
-        for (const auto& line : committed.lines) {
+        for (const auto line : committed.lines) {
             RenderLine rl;
             rl.kind = RenderLineKind::Deleted;
-            rl.text = line;
+            rl.text = std::string(line);
             lines.push_back(std::move(rl));
         }
         return lines;
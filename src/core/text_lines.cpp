@@ -0,0 +1,71 @@
+#include "text_lines.h"
+
+#include <algorithm>
+
+namespace bendiff::core {
+
+TextLines::Builder::Builder()
+    : m_offsets{0}
+{
+}
+
+void TextLines::Builder::Reserve(std::size_t byteCount, std::size_t lineCount)
+{
+    m_bytes.reserve(byteCount);
+    m_offsets.reserve(lineCount + 1);
+}
+
+void TextLines::Builder::Append(std::string_view line)
+{
+    m_bytes.append(line);
+    m_offsets.push_back(m_bytes.size());
+}
+
+TextLines TextLines::Builder::Finish()
+{
+    TextLines out;
+    if (size() > 0) {
+        out.m_storage = std::make_shared<const Storage>(Storage{
+            .bytes = std::move(m_bytes),
+            .offsets = std::move(m_offsets),
+        });
+    }
+    *this = Builder();
+    return out;
+}
+
+TextLines::TextLines(const std::vector<std::string>& lines)
+{
+    Builder builder;
+    std::size_t byteCount = 0;
+    for (const auto& line : lines) {
+        byteCount += line.size();
+    }
+    builder.Reserve(byteCount, lines.size());
+    for (const auto& line : lines) {
+        builder.Append(line);
+    }
+    *this = builder.Finish();
+}
+
+TextLines::TextLines(std::initializer_list<std::string_view> lines)
+{
+    Builder builder;
+    builder.Reserve(0, lines.size());
+    for (const auto line : lines) {
+        builder.Append(line);
+    }
+    *this = builder.Finish();
+}
+
+bool operator==(const TextLines& a, const TextLines& b)
+{
+    return std::ranges::equal(a, b);
+}
+
+bool operator==(const TextLines& a, const std::vector<std::string>& b)
+{
+    return std::ranges::equal(a, b);
+}
+
+} // namespace bendiff::core
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bendiff::core {
+
+// Immutable, shared list of text lines (without line endings).
+//
+// All lines live back to back in one byte buffer, indexed by an offset array,
+// so a file of N lines costs two allocations and 8 bytes of overhead per line
+// rather than N strings. Copies share the ref-counted store, so copying is
+// O(1), and the views handed out by operator[] and the iterators point into
+// that store: they stay valid for as long as any copy of the list is alive,
+// not just the one they came from. Render documents rely on this to
+// reference line text instead of copying it.
+class TextLines {
+    struct Storage;
+
+public:
+    // Appends lines one by one, then hands them over as a TextLines.
+    class Builder {
+    public:
+        Builder();
+
+        void Reserve(std::size_t byteCount, std::size_t lineCount);
+        void Append(std::string_view line);
+        std::size_t size() const { return m_offsets.size() - 1; }
+
+        // Leaves the builder empty.
+        TextLines Finish();
+
+    private:
+        std::string m_bytes;
+        std::vector<std::uint64_t> m_offsets;
+    };
+
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::string_view;
+
+        const_iterator() = default;
+
+        std::string_view operator*() const { return Line(*m_storage, m_index); }
+        std::string_view operator[](difference_type n) const
+        {
+            return Line(*m_storage, m_index + static_cast<std::size_t>(n));
+        }
+
+        const_iterator& operator++() { ++m_index; return *this; }
+        const_iterator operator++(int) { auto old = *this; ++m_index; return old; }
+        const_iterator& operator--() { --m_index; return *this; }
+        const_iterator operator--(int) { auto old = *this; --m_index; return old; }
+        const_iterator& operator+=(difference_type n) { m_index += static_cast<std::size_t>(n); return *this; }
+        const_iterator& operator-=(difference_type n) { m_index -= static_cast<std::size_t>(n); return *this; }
+
+        friend const_iterator operator+(const_iterator it, difference_type n) { return it += n; }
+        friend const_iterator operator+(difference_type n, const_iterator it) { return it += n; }
+        friend const_iterator operator-(const_iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const const_iterator& a, const const_iterator& b)
+        {
+            return static_cast<difference_type>(a.m_index) - static_cast<difference_type>(b.m_index);
+        }
+        friend bool operator==(const const_iterator& a, const const_iterator& b) { return a.m_index == b.m_index; }
+        friend auto operator<=>(const const_iterator& a, const const_iterator& b) { return a.m_index <=> b.m_index; }
+
+    private:
+        friend class TextLines;
+        const_iterator(const Storage* storage, std::size_t index)
+            : m_storage(storage)
+            , m_index(index)
+        {
+        }
+
+        // The shared store rather than the list, so the iterator outlives the
+        // TextLines object it came from as long as some copy remains.
+        const Storage* m_storage = nullptr;
+        std::size_t m_index = 0;
+    };
+
+    using iterator = const_iterator;
+    using value_type = std::string_view;
+    using size_type = std::size_t;
+
+    TextLines() = default;
+    explicit TextLines(const std::vector<std::string>& lines);
+    TextLines(std::initializer_list<std::string_view> lines);
+
+    std::size_t size() const { return m_storage ? m_storage->offsets.size() - 1 : 0; }
+    bool empty() const { return size() == 0; }
+
+    std::string_view operator[](std::size_t i) const { return Line(*m_storage, i); }
+
+    const_iterator begin() const { return const_iterator(m_storage.get(), 0); }
+    const_iterator end() const { return const_iterator(m_storage.get(), size()); }
+
+    friend bool operator==(const TextLines& a, const TextLines& b);
+    friend bool operator==(const TextLines& a, const std::vector<std::string>& b);
+
+private:
+    struct Storage {
+        std::string bytes;
+        // size() + 1 entries; line i is bytes[offsets[i], offsets[i + 1]).
+        std::vector<std::uint64_t> offsets;
+    };
+
+    static std::string_view Line(const Storage& storage, std::size_t i)
+    {
+        const auto begin = storage.offsets[i];
+        const auto end = storage.offsets[i + 1];
+        return std::string_view(storage.bytes.data() + begin, static_cast<std::size_t>(end - begin));
+    }
+
+    std::shared_ptr<const Storage> m_storage;
+};
+
+} // namespace bendiff::core
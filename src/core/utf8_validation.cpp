@@ -0,0 +1,405 @@
+#include "utf8_validation.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BENDIFF_UTF8_X86 1
+#include <immintrin.h>
+#else
+#define BENDIFF_UTF8_X86 0
+#endif
+
+namespace bendiff::core {
+namespace {
+
+// RFC 3629 style UTF-8 validation, one sequence at a time. The reference
+// implementation the vector kernels are tested against.
+bool IsValidUtf8Scalar(std::string_view bytes)
+{
+    std::size_t i = 0;
+    while (i < bytes.size()) {
+        const unsigned char c = static_cast<unsigned char>(bytes[i]);
+
+        if (c <= 0x7F) {
+            ++i;
+            continue;
+        }
+
+        auto is_cont = [&](std::size_t idx) {
+            if (idx >= bytes.size()) {
+                return false;
+            }
+            const unsigned char cc = static_cast<unsigned char>(bytes[idx]);
+            return (cc & 0xC0) == 0x80;
+        };
+
+        if (c >= 0xC2 && c <= 0xDF) {
+            // 2-byte sequence
+            if (!is_cont(i + 1)) {
+                return false;
+            }
+            i += 2;
+            continue;
+        }
+
+        if (c == 0xE0) {
+            // 3-byte sequence, special lower bound to avoid overlongs
+            if (!is_cont(i + 1) || !is_cont(i + 2)) {
+                return false;
+            }
+            const unsigned char c1 = static_cast<unsigned char>(bytes[i + 1]);
+            if (c1 < 0xA0) {
+                return false;
+            }
+            i += 3;
+            continue;
+        }
+
+        if (c >= 0xE1 && c <= 0xEC) {
+            if (!is_cont(i + 1) || !is_cont(i + 2)) {
+                return false;
+            }
+            i += 3;
+            continue;
+        }
+
+        if (c == 0xED) {
+            // exclude UTF-16 surrogate halves
+            if (!is_cont(i + 1) || !is_cont(i + 2)) {
+                return false;
+            }
+            const unsigned char c1 = static_cast<unsigned char>(bytes[i + 1]);
+            if (c1 >= 0xA0) {
+                return false;
+            }
+            i += 3;
+            continue;
+        }
+
+        if (c >= 0xEE && c <= 0xEF) {
+            if (!is_cont(i + 1) || !is_cont(i + 2)) {
+                return false;
+            }
+            i += 3;
+            continue;
+        }
+
+        if (c == 0xF0) {
+            // 4-byte, special lower bound
+            if (!is_cont(i + 1) || !is_cont(i + 2) || !is_cont(i + 3)) {
+                return false;
+            }
+            const unsigned char c1 = static_cast<unsigned char>(bytes[i + 1]);
+            if (c1 < 0x90) {
+                return false;
+            }
+            i += 4;
+            continue;
+        }
+
+        if (c >= 0xF1 && c <= 0xF3) {
+            if (!is_cont(i + 1) || !is_cont(i + 2) || !is_cont(i + 3)) {
+                return false;
+            }
+            i += 4;
+            continue;
+        }
+
+        if (c == 0xF4) {
+            // 4-byte, special upper bound (max U+10FFFF)
+            if (!is_cont(i + 1) || !is_cont(i + 2) || !is_cont(i + 3)) {
+                return false;
+            }
+            const unsigned char c1 = static_cast<unsigned char>(bytes[i + 1]);
+            if (c1 > 0x8F) {
+                return false;
+            }
+            i += 4;
+            continue;
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+#if BENDIFF_UTF8_X86
+
+// Vector kernels: the lookup algorithm from Keiser & Lemire, "Validating
+// UTF-8 In Less Than One Instruction Per Byte" (2021).
+//
+// Every byte is classified together with the byte before it: three 16-entry
+// tables, indexed by the previous byte's high and low nibble and the current
+// byte's high nibble, each give the set of errors that pair might be. An
+// error is real only if all three agree. The one rule two bytes can't decide
+// (a continuation byte is needed 2 or 3 bytes after a 3/4-byte lead) is
+// checked separately. Blocks are processed with the previous block's tail
+// shifted in, so sequences may straddle blocks; a final all-zero block flags
+// a sequence cut off by the end of the input.
+
+constexpr std::uint8_t kTooShort = 1 << 0;  // lead byte not followed by a continuation
+constexpr std::uint8_t kTooLong = 1 << 1;   // ASCII followed by a continuation
+constexpr std::uint8_t kOverlong3 = 1 << 2; // E0 80..9F
+constexpr std::uint8_t kTooLarge = 1 << 3;  // above U+10FFFF
+constexpr std::uint8_t kSurrogate = 1 << 4; // ED A0..BF
+constexpr std::uint8_t kOverlong2 = 1 << 5; // C0/C1 lead
+constexpr std::uint8_t kTooLarge1000 = 1 << 6;
+constexpr std::uint8_t kOverlong4 = 1 << 6; // F0 80..8F
+constexpr std::uint8_t kTwoConts = 1 << 7;  // continuation after continuation
+constexpr std::uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+// Indexed by the high nibble of the previous byte.
+constexpr std::array<std::uint8_t, 16> kByte1High = {
+    // 0_______: ASCII
+    kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+    // 10______: continuation
+    kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+    // 1100____, 1101____: two-byte lead
+    kTooShort | kOverlong2,
+    kTooShort,
+    // 1110____: three-byte lead
+    kTooShort | kOverlong3 | kSurrogate,
+    // 1111____: four-byte lead
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4,
+};
+
+// Indexed by the low nibble of the previous byte.
+constexpr std::array<std::uint8_t, 16> kByte1Low = {
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4, // ____0000
+    kCarry | kOverlong2,                           // ____0001
+    kCarry,                                        // ____0010
+    kCarry,                                        // ____0011
+    kCarry | kTooLarge,                            // ____0100
+    kCarry | kTooLarge | kTooLarge1000,            // ____0101 and up
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate, // ____1101
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+};
+
+// Indexed by the high nibble of the current byte.
+constexpr std::array<std::uint8_t, 16> kByte2High = {
+    // 0_______: ASCII
+    kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+    // 1000____
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4,
+    // 1001____
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+    // 101_____
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    // 11______: lead
+    kTooShort, kTooShort, kTooShort, kTooShort,
+};
+
+// A saturating subtract of these leaves bit 7 set only for 111_____ (lead of
+// a 3- or 4-byte sequence) and 1111____ (lead of a 4-byte sequence) bytes.
+constexpr char kThirdByteBias = static_cast<char>(0xE0 - 0x80);
+constexpr char kFourthByteBias = static_cast<char>(0xF0 - 0x80);
+
+// --- SSE4.1 (16 bytes per step) ---
+
+__attribute__((target("sse4.1"))) __m128i LoadTableSse(const std::array<std::uint8_t, 16>& table)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.data()));
+}
+
+// Error bits for `input`, given the block before it.
+__attribute__((target("sse4.1"))) __m128i CheckBlockSse(__m128i input, __m128i prev)
+{
+    const __m128i lowNibble = _mm_set1_epi8(0x0F);
+
+    const __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+    const __m128i byte1High = _mm_shuffle_epi8(LoadTableSse(kByte1High), _mm_and_si128(_mm_srli_epi16(prev1, 4), lowNibble));
+    const __m128i byte1Low = _mm_shuffle_epi8(LoadTableSse(kByte1Low), _mm_and_si128(prev1, lowNibble));
+    const __m128i byte2High = _mm_shuffle_epi8(LoadTableSse(kByte2High), _mm_and_si128(_mm_srli_epi16(input, 4), lowNibble));
+    const __m128i special = _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+    const __m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+    const __m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+    const __m128i isThird = _mm_subs_epu8(prev2, _mm_set1_epi8(kThirdByteBias));
+    const __m128i isFourth = _mm_subs_epu8(prev3, _mm_set1_epi8(kFourthByteBias));
+    const __m128i must23 = _mm_and_si128(_mm_or_si128(isThird, isFourth), _mm_set1_epi8(static_cast<char>(0x80)));
+
+    return _mm_xor_si128(must23, special);
+}
+
+// Returns false once `input` is known to make the text invalid.
+__attribute__((target("sse4.1"))) bool StepSse(__m128i input, __m128i& prev, bool& prevAscii)
+{
+    const bool ascii = _mm_movemask_epi8(input) == 0;
+    bool ok = true;
+    // An all-ASCII block after an all-ASCII block can't contain an error.
+    if (!ascii || !prevAscii) {
+        const __m128i error = CheckBlockSse(input, prev);
+        ok = _mm_testz_si128(error, error) != 0;
+    }
+    prev = input;
+    prevAscii = ascii;
+    return ok;
+}
+
+__attribute__((target("sse4.1"))) bool IsValidUtf8Sse4(std::string_view bytes)
+{
+    constexpr std::size_t kBlock = 16;
+
+    __m128i prev = _mm_setzero_si128();
+    bool prevAscii = true;
+
+    std::size_t i = 0;
+    for (; i + kBlock <= bytes.size(); i += kBlock) {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data() + i));
+        if (!StepSse(input, prev, prevAscii)) {
+            return false;
+        }
+    }
+
+    if (i < bytes.size()) {
+        std::array<char, kBlock> tail{};
+        std::memcpy(tail.data(), bytes.data() + i, bytes.size() - i);
+        if (!StepSse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tail.data())), prev, prevAscii)) {
+            return false;
+        }
+    }
+
+    return StepSse(_mm_setzero_si128(), prev, prevAscii);
+}
+
+// --- AVX2 (32 bytes per step) ---
+
+__attribute__((target("avx2"))) __m256i LoadTableAvx2(const std::array<std::uint8_t, 16>& table)
+{
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table.data())));
+}
+
+// The last N bytes of `prev` followed by all but the last N bytes of `input`.
+template <int N>
+__attribute__((target("avx2"))) __m256i ShiftInAvx2(__m256i input, __m256i prev)
+{
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21), 16 - N);
+}
+
+__attribute__((target("avx2"))) __m256i CheckBlockAvx2(__m256i input, __m256i prev)
+{
+    const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+
+    const __m256i prev1 = ShiftInAvx2<1>(input, prev);
+    const __m256i byte1High = _mm256_shuffle_epi8(LoadTableAvx2(kByte1High), _mm256_and_si256(_mm256_srli_epi16(prev1, 4), lowNibble));
+    const __m256i byte1Low = _mm256_shuffle_epi8(LoadTableAvx2(kByte1Low), _mm256_and_si256(prev1, lowNibble));
+    const __m256i byte2High = _mm256_shuffle_epi8(LoadTableAvx2(kByte2High), _mm256_and_si256(_mm256_srli_epi16(input, 4), lowNibble));
+    const __m256i special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+    const __m256i prev2 = ShiftInAvx2<2>(input, prev);
+    const __m256i prev3 = ShiftInAvx2<3>(input, prev);
+    const __m256i isThird = _mm256_subs_epu8(prev2, _mm256_set1_epi8(kThirdByteBias));
+    const __m256i isFourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(kFourthByteBias));
+    const __m256i must23 = _mm256_and_si256(_mm256_or_si256(isThird, isFourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+
+    return _mm256_xor_si256(must23, special);
+}
+
+__attribute__((target("avx2"))) bool StepAvx2(__m256i input, __m256i& prev, bool& prevAscii)
+{
+    const bool ascii = _mm256_movemask_epi8(input) == 0;
+    bool ok = true;
+    if (!ascii || !prevAscii) {
+        const __m256i error = CheckBlockAvx2(input, prev);
+        ok = _mm256_testz_si256(error, error) != 0;
+    }
+    prev = input;
+    prevAscii = ascii;
+    return ok;
+}
+
+__attribute__((target("avx2"))) bool IsValidUtf8Avx2(std::string_view bytes)
+{
+    constexpr std::size_t kBlock = 32;
+
+    __m256i prev = _mm256_setzero_si256();
+    bool prevAscii = true;
+
+    std::size_t i = 0;
+
+    // ASCII fast path: 64 bytes per test while the text is plain ASCII.
+    while (i + 2 * kBlock <= bytes.size()) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes.data() + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes.data() + i + kBlock));
+        if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0) {
+            break;
+        }
+        prev = b;
+        i += 2 * kBlock;
+    }
+
+    for (; i + kBlock <= bytes.size(); i += kBlock) {
+        const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes.data() + i));
+        if (!StepAvx2(input, prev, prevAscii)) {
+            return false;
+        }
+    }
+
+    if (i < bytes.size()) {
+        std::array<char, kBlock> tail{};
+        std::memcpy(tail.data(), bytes.data() + i, bytes.size() - i);
+        if (!StepAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail.data())), prev, prevAscii)) {
+            return false;
+        }
+    }
+
+    return StepAvx2(_mm256_setzero_si256(), prev, prevAscii);
+}
+
+#endif // BENDIFF_UTF8_X86
+
+} // namespace
+
+std::vector<Utf8Kernel> AvailableUtf8Kernels()
+{
+    std::vector<Utf8Kernel> out = {Utf8Kernel::Scalar};
+#if BENDIFF_UTF8_X86
+    if (__builtin_cpu_supports("sse4.1")) {
+        out.push_back(Utf8Kernel::Sse4);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        out.push_back(Utf8Kernel::Avx2);
+    }
+#endif
+    return out;
+}
+
+Utf8Kernel BestUtf8Kernel()
+{
+    static const Utf8Kernel best = AvailableUtf8Kernels().back();
+    return best;
+}
+
+bool IsValidUtf8With(Utf8Kernel kernel, std::string_view bytes)
+{
+    switch (kernel) {
+    case Utf8Kernel::Scalar:
+        break;
+#if BENDIFF_UTF8_X86
+    case Utf8Kernel::Sse4:
+        return IsValidUtf8Sse4(bytes);
+    case Utf8Kernel::Avx2:
+        return IsValidUtf8Avx2(bytes);
+#else
+    case Utf8Kernel::Sse4:
+    case Utf8Kernel::Avx2:
+        break;
+#endif
+    }
+    return IsValidUtf8Scalar(bytes);
+}
+
+} // namespace bendiff::core
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+namespace bendiff::core {
+
+// Implementations of the UTF-8 check behind IsValidUtf8(). All kernels give
+// the same answer; the vector ones classify 16 (Sse4) or 32 (Avx2) bytes per
+// step with table lookups and skip all-ASCII blocks with a single test.
+enum class Utf8Kernel {
+    Scalar,
+    Sse4,
+    Avx2,
+};
+
+// Kernels this build and CPU can run, Scalar first and fastest last.
+std::vector<Utf8Kernel> AvailableUtf8Kernels();
+
+// The kernel IsValidUtf8() uses (the last of AvailableUtf8Kernels()).
+Utf8Kernel BestUtf8Kernel();
+
+// RFC 3629 validation with a specific kernel; `kernel` must be available.
+bool IsValidUtf8With(Utf8Kernel kernel, std::string_view bytes);
+
+} // namespace bendiff::core
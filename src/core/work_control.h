@@ -0,0 +1,33 @@
+#pragma once
+
+#include <functional>
+#include <stop_token>
+
+namespace bendiff::core {
+
+// Cooperative cancellation and progress reporting for long-running core work
+// (diffing, render building).
+//
+// - `stop`: the operation polls it and returns early, flagged as cancelled,
+//   soon after a stop is requested. A default-constructed token never stops.
+// - `progress`: optional; called on the working thread with the completed
+//   fraction in [0, 1]. Calls are throttled and non-decreasing, and a
+//   cancelled operation may stop reporting before 1.
+struct WorkControl {
+    std::stop_token stop;
+    std::function<void(double fraction)> progress;
+
+    bool StopRequested() const
+    {
+        return stop.stop_requested();
+    }
+
+    void ReportProgress(double fraction) const
+    {
+        if (progress) {
+            progress(fraction);
+        }
+    }
+};
+
+} // namespace bendiff::core
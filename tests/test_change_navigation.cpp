@@ -64,4 +64,57 @@ TEST(ChangeNavigation, EmptyChangesReturnNullopt)
     EXPECT_EQ(PrevChangeIndex(std::nullopt, empty), std::nullopt);
 }
 
+TEST(ChangeNavigation, HunkRowLookupsBinarySearchTheIndex)
+{
+    const std::vector<HunkRows> hunks = {{.firstRow = 2, .rowCount = 2}, {.firstRow = 7, .rowCount = 1}, {.firstRow = 10, .rowCount = 3}};
+
+    EXPECT_EQ(FirstRowOfHunk(hunks, 1), 7u);
+    EXPECT_EQ(FirstRowOfHunk(hunks, 3), std::nullopt);
+
+    EXPECT_EQ(HunkAtRow(hunks, 0), std::nullopt);
+    EXPECT_EQ(HunkAtRow(hunks, 2), 0u);
+    EXPECT_EQ(HunkAtRow(hunks, 3), 0u);
+    EXPECT_EQ(HunkAtRow(hunks, 4), std::nullopt);
+    EXPECT_EQ(HunkAtRow(hunks, 7), 1u);
+    EXPECT_EQ(HunkAtRow(hunks, 12), 2u);
+    EXPECT_EQ(HunkAtRow(hunks, 13), std::nullopt);
+
+    EXPECT_EQ(NextHunkAfterRow(hunks, 0), 0u);
+    EXPECT_EQ(NextHunkAfterRow(hunks, 2), 1u);
+    EXPECT_EQ(NextHunkAfterRow(hunks, 9), 2u);
+    EXPECT_EQ(NextHunkAfterRow(hunks, 10), std::nullopt);
+
+    EXPECT_EQ(PrevHunkBeforeRow(hunks, 2), std::nullopt);
+    EXPECT_EQ(PrevHunkBeforeRow(hunks, 3), 0u);
+    EXPECT_EQ(PrevHunkBeforeRow(hunks, 10), 1u);
+    EXPECT_EQ(PrevHunkBeforeRow(hunks, 100), 2u);
+
+    EXPECT_EQ(HunkAtRow({}, 0), std::nullopt);
+    EXPECT_EQ(NextHunkAfterRow({}, 0), std::nullopt);
+    EXPECT_EQ(PrevHunkBeforeRow({}, 0), std::nullopt);
+}
+
+TEST(ChangeNavigation, StepsFromTheCurrentHunkOrTheScrollPosition)
+{
+    const std::vector<HunkRows> hunks = {{.firstRow = 2, .rowCount = 2}, {.firstRow = 7, .rowCount = 1}, {.firstRow = 10, .rowCount = 3}};
+    const VisibleRows top = {.firstRow = 0, .rowCount = 5};
+
+    // The current hunk is on screen: step from it, wrapping at the ends.
+    EXPECT_EQ(NextHunkFromView(hunks, 0, top), 1u);
+    EXPECT_EQ(PrevHunkFromView(hunks, 0, top), 2u);
+    EXPECT_EQ(NextHunkFromView(hunks, 2, {.firstRow = 8, .rowCount = 5}), 0u);
+
+    // Scrolled away from it: step from the position instead.
+    const VisibleRows atFive = {.firstRow = 5, .rowCount = 1};
+    EXPECT_EQ(NextHunkFromView(hunks, 0, atFive), 1u);
+    EXPECT_EQ(PrevHunkFromView(hunks, 2, atFive), 0u);
+    EXPECT_EQ(NextHunkFromView(hunks, std::nullopt, {.firstRow = 11, .rowCount = 1}), 0u); // in hunk 2
+    EXPECT_EQ(PrevHunkFromView(hunks, std::nullopt, {.firstRow = 11, .rowCount = 1}), 1u);
+    EXPECT_EQ(NextHunkFromView(hunks, std::nullopt, {.firstRow = 20, .rowCount = 5}), 0u);
+    EXPECT_EQ(PrevHunkFromView(hunks, std::nullopt, {.firstRow = 1, .rowCount = 1}), 2u);
+
+    EXPECT_EQ(NextHunkFromView({}, std::nullopt, top), std::nullopt);
+    EXPECT_EQ(PrevHunkFromView({}, std::nullopt, top), std::nullopt);
+}
+
 } // namespace bendiff::core::navigation
@@ -0,0 +1,293 @@
+#include <content_hash_cache.h>
+#include <dir_diff.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path make_unique_temp_dir(const std::string& prefix)
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    const auto stamp = std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+
+    fs::path dir = fs::temp_directory_path() / (prefix + "_" + stamp);
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+void write_file(const fs::path& p, const std::string& bytes)
+{
+    fs::create_directories(p.parent_path());
+    std::ofstream out(p, std::ios::binary);
+    ASSERT_TRUE(out.good()) << p;
+    out << bytes;
+}
+
+// Files written just now are too fresh to be recorded; backdate them.
+void backdate(const fs::path& p)
+{
+    fs::last_write_time(p, fs::file_time_type::clock::now() - std::chrono::hours(1));
+}
+
+bendiff::core::FileMetadata metadata_of(const fs::path& root, const std::string& rel)
+{
+    for (const auto& f : bendiff::core::ListFilesWithMetadata(root)) {
+        if (f.relativePath == rel) {
+            return f.metadata;
+        }
+    }
+    return {};
+}
+
+// Hashes `path` and records it, as the folder compare does on a cache miss.
+std::optional<bendiff::core::ContentHash> record(bendiff::core::ContentHashCache& cache,
+                                                 const fs::path& path,
+                                                 const bendiff::core::FileMetadata& metadata)
+{
+    auto hash = bendiff::core::HashFile(path);
+    if (hash) {
+        cache.Store(path, metadata, *hash);
+    }
+    return hash;
+}
+
+std::map<std::string, bendiff::core::DirEntryStatus> statuses(const bendiff::core::DirDiffResult& r)
+{
+    std::map<std::string, bendiff::core::DirEntryStatus> byPath;
+    for (const auto& e : r.entries) {
+        byPath[std::string(e.relativePath())] = e.status;
+    }
+    return byPath;
+}
+
+} // namespace
+
+TEST(ContentHash, DependsOnEveryByteAndTheLength)
+{
+    using bendiff::core::HashBytes;
+
+    const std::string base(100, 'x');
+    EXPECT_EQ(HashBytes(base), HashBytes(std::string(100, 'x')));
+    for (std::size_t i : {0u, 31u, 32u, 63u, 99u}) {
+        std::string changed = base;
+        changed[i] = 'y';
+        EXPECT_NE(HashBytes(changed), HashBytes(base)) << i;
+    }
+
+    // Zero padding of the tail must not make lengths collide.
+    EXPECT_NE(HashBytes(std::string(3, '\0')), HashBytes(std::string(4, '\0')));
+    EXPECT_NE(HashBytes(std::string(32, '\0')), HashBytes(std::string()));
+}
+
+TEST(ContentHash, IncrementalHashMatchesOneShotForAnySplit)
+{
+    std::string bytes;
+    for (int i = 0; i < 200; ++i) {
+        bytes += static_cast<char>(i * 7);
+    }
+    const auto whole = bendiff::core::HashBytes(bytes);
+    for (std::size_t step : {1u, 5u, 31u, 32u, 33u, 64u, 199u}) {
+        bendiff::core::ContentHasher hasher;
+        for (std::size_t i = 0; i < bytes.size(); i += step) {
+            hasher.Update(std::string_view(bytes).substr(i, step));
+        }
+        EXPECT_EQ(hasher.Finish(), whole) << step;
+    }
+}
+
+TEST(ContentHashCache, RoundTripsAndMissesOnChangedMetadata)
+{
+    const auto root = make_unique_temp_dir("bendiff_hash_cache");
+    const auto file = root / "tree" / "a.txt";
+    write_file(file, "alpha\n");
+    backdate(file);
+
+    const auto meta = metadata_of(root / "tree", "a.txt");
+    ASSERT_TRUE(meta.valid);
+
+    bendiff::core::ContentHashCache cache(root / "cache" / "content-hashes");
+    EXPECT_FALSE(cache.Load()); // no file yet
+    const auto hash = record(cache, file, meta);
+    ASSERT_TRUE(hash.has_value());
+    EXPECT_EQ(*hash, bendiff::core::HashBytes("alpha\n"));
+    ASSERT_TRUE(cache.Save());
+
+    bendiff::core::ContentHashCache reloaded(cache.file());
+    ASSERT_TRUE(reloaded.Load());
+    EXPECT_EQ(reloaded.size(), 1u);
+    EXPECT_EQ(reloaded.Lookup(file, meta), hash);
+
+    auto touched = meta;
+    touched.mtimeNs += 1;
+    EXPECT_FALSE(reloaded.Lookup(file, touched).has_value());
+    auto resized = meta;
+    resized.size += 1;
+    EXPECT_FALSE(reloaded.Lookup(file, resized).has_value());
+
+    // A foreign or truncated file loads as empty.
+    write_file(cache.file(), "not a cache");
+    EXPECT_FALSE(reloaded.Load());
+    EXPECT_EQ(reloaded.size(), 0u);
+
+    fs::remove_all(root);
+}
+
+TEST(ContentHashCache, DoesNotRecordFreshlyModifiedFiles)
+{
+    const auto root = make_unique_temp_dir("bendiff_hash_cache_fresh");
+    write_file(root / "tree" / "a.txt", "alpha\n");
+
+    bendiff::core::ContentHashCache cache(root / "content-hashes");
+    const auto meta = metadata_of(root / "tree", "a.txt");
+    EXPECT_TRUE(record(cache, root / "tree" / "a.txt", meta).has_value());
+    EXPECT_EQ(cache.size(), 0u);
+
+    fs::remove_all(root);
+}
+
+TEST(DirDiff, HashCacheDecidesUnchangedFilesWithoutRereading)
+{
+    const auto root = make_unique_temp_dir("bendiff_dir_diff_hash_cache");
+    const auto left = root / "left";
+    const auto right = root / "right";
+    write_file(left / "same.txt", "same\n");
+    write_file(right / "same.txt", "same\n");
+    write_file(left / "diff.txt", "left\n");
+    write_file(right / "diff.txt", "rght\n");
+    for (const auto* rel : {"same.txt", "diff.txt"}) {
+        backdate(left / rel);
+        backdate(right / rel);
+    }
+
+    bendiff::core::ContentHashCache cache(root / "content-hashes");
+    const auto first = bendiff::core::DiffDirectories(left, right, {.compareThreads = 2, .hashCache = &cache});
+    EXPECT_EQ(statuses(first), statuses(bendiff::core::DiffDirectories(left, right)));
+    EXPECT_EQ(statuses(first)["same.txt"], bendiff::core::DirEntryStatus::Same);
+    EXPECT_EQ(statuses(first)["diff.txt"], bendiff::core::DirEntryStatus::Different);
+    EXPECT_EQ(cache.size(), 4u);
+
+    // Rewrite diff.txt's left side to match the right, keeping its size and
+    // (backdated) mtime different from the recorded one: it is rehashed.
+    write_file(left / "diff.txt", "rght\n");
+    fs::last_write_time(left / "diff.txt", fs::file_time_type::clock::now() - std::chrono::hours(2));
+
+    // Rewrite same.txt's left side but restore the recorded metadata: the
+    // cache can't see the change, which shows the hash was not recomputed.
+    const auto mtime = fs::last_write_time(left / "same.txt");
+    {
+        std::fstream out(left / "same.txt", std::ios::in | std::ios::out | std::ios::binary);
+        out << "SAME\n";
+    }
+    fs::last_write_time(left / "same.txt", mtime);
+
+    const auto second = bendiff::core::DiffDirectories(left, right, {.compareThreads = 1, .hashCache = &cache});
+    EXPECT_EQ(statuses(second)["diff.txt"], bendiff::core::DirEntryStatus::Same);
+    EXPECT_EQ(statuses(second)["same.txt"], bendiff::core::DirEntryStatus::Same);
+
+    fs::remove_all(root);
+}
+
+TEST(DirDiff, HashCacheIsOnlyRewrittenWhenARefreshChangesIt)
+{
+    const auto root = make_unique_temp_dir("bendiff_dir_diff_hash_cache_save");
+    const auto left = root / "left";
+    const auto right = root / "right";
+    for (const auto* rel : {"a.txt", "b.txt", "gone.txt"}) {
+        write_file(left / rel, std::string("content of ") + rel);
+        write_file(right / rel, std::string("content of ") + rel);
+        backdate(left / rel);
+        backdate(right / rel);
+    }
+
+    bendiff::core::ContentHashCache cache(root / "cache" / "content-hashes");
+    (void)bendiff::core::DiffDirectories(left, right, {.hashCache = &cache});
+    EXPECT_EQ(cache.size(), 6u);
+    ASSERT_TRUE(cache.Save());
+    ASSERT_TRUE(fs::exists(cache.file()));
+
+    // A refresh that changes nothing leaves the file alone.
+    fs::remove(cache.file());
+    (void)bendiff::core::DiffDirectories(left, right, {.hashCache = &cache});
+    EXPECT_TRUE(cache.Save());
+    EXPECT_FALSE(fs::exists(cache.file()));
+
+    // Deleting a file drops its records, and that is saved.
+    fs::remove(left / "gone.txt");
+    fs::remove(right / "gone.txt");
+    (void)bendiff::core::DiffDirectories(left, right, {.hashCache = &cache});
+    EXPECT_EQ(cache.size(), 4u);
+    EXPECT_TRUE(cache.Save());
+    ASSERT_TRUE(fs::exists(cache.file()));
+
+    bendiff::core::ContentHashCache reloaded(cache.file());
+    ASSERT_TRUE(reloaded.Load());
+    EXPECT_EQ(reloaded.size(), 4u);
+
+    fs::remove_all(root);
+}
+
+TEST(ContentHashCache, PruneUnderKeepsOtherTreesAndUsedRecords)
+{
+    const auto root = make_unique_temp_dir("bendiff_hash_cache_prune");
+    for (const auto* rel : {"tree/used.txt", "tree/unused.txt", "other/kept.txt"}) {
+        write_file(root / rel, rel);
+        backdate(root / rel);
+    }
+
+    bendiff::core::ContentHashCache cache(root / "content-hashes");
+    for (const auto* rel : {"used.txt", "unused.txt"}) {
+        ASSERT_TRUE(record(cache, root / "tree" / rel, metadata_of(root / "tree", rel)).has_value());
+    }
+    ASSERT_TRUE(record(cache, root / "other" / "kept.txt", metadata_of(root / "other", "kept.txt")).has_value());
+    ASSERT_EQ(cache.size(), 3u);
+
+    cache.BeginPass();
+    EXPECT_TRUE(cache.Lookup(root / "tree" / "used.txt", metadata_of(root / "tree", "used.txt")).has_value());
+    EXPECT_EQ(cache.PruneUnder(root / "tree"), 1u);
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_TRUE(cache.Lookup(root / "other" / "kept.txt", metadata_of(root / "other", "kept.txt")).has_value());
+
+    fs::remove_all(root);
+}
+
+TEST(ContentHashCache, LoadDropsRecordsOfDeletedTrees)
+{
+    const auto root = make_unique_temp_dir("bendiff_hash_cache_gone");
+    for (const auto* rel : {"kept/a.txt", "gone/sub/b.txt", "gone/c.txt"}) {
+        write_file(root / rel, rel);
+        backdate(root / rel);
+    }
+
+    bendiff::core::ContentHashCache cache(root / "cache" / "content-hashes");
+    ASSERT_TRUE(record(cache, root / "kept" / "a.txt", metadata_of(root / "kept", "a.txt")).has_value());
+    ASSERT_TRUE(record(cache, root / "gone" / "sub" / "b.txt", metadata_of(root / "gone", "sub/b.txt")).has_value());
+    ASSERT_TRUE(record(cache, root / "gone" / "c.txt", metadata_of(root / "gone", "c.txt")).has_value());
+    ASSERT_TRUE(cache.Save());
+
+    // A tree that was deleted (as difftool deletes its temporary copies) is
+    // never compared again; its records go on the next Load(), and the
+    // smaller cache is saved.
+    fs::remove_all(root / "gone");
+    bendiff::core::ContentHashCache reloaded(cache.file());
+    ASSERT_TRUE(reloaded.Load());
+    EXPECT_EQ(reloaded.size(), 1u);
+    EXPECT_TRUE(reloaded.Lookup(root / "kept" / "a.txt", metadata_of(root / "kept", "a.txt")).has_value());
+
+    fs::remove(cache.file());
+    ASSERT_TRUE(reloaded.Save());
+    bendiff::core::ContentHashCache saved(cache.file());
+    ASSERT_TRUE(saved.Load());
+    EXPECT_EQ(saved.size(), 1u);
+
+    fs::remove_all(root);
+}
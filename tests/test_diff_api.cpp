@@ -1,4 +1,5 @@
 #include <diff/diff.h>
+#include <loaded_text_file.h>
 
 #include <gtest/gtest.h>
 
@@ -19,4 +20,26 @@ TEST(DiffApi, CanCallDiffLinesAndGetCounts)
     EXPECT_EQ(r.rightLineCount, right.size());
 }
 
+TEST(DiffApi, LoadedFilesDiffLikeTheirLines)
+{
+    const auto left = LoadUtf8TextFromBytes("a\nb \nc\nd\n", "left");
+    const auto right = LoadUtf8TextFromBytes("a\nb\nx\nd\ne\n", "right");
+    ASSERT_EQ(left.hashes.size(), left.lines.size());
+
+    for (const auto mode : {WhitespaceMode::Exact, WhitespaceMode::IgnoreTrailing, WhitespaceMode::IgnoreAll}) {
+        const auto fromFiles = DiffLines(left, right, mode, DiffOptions{});
+        const auto fromLines = DiffLines(left.lines, right.lines, mode);
+
+        EXPECT_EQ(fromFiles.leftLineCount, 4u);
+        EXPECT_EQ(fromFiles.rightLineCount, 5u);
+        ASSERT_EQ(fromFiles.hunks.size(), fromLines.hunks.size());
+        for (std::size_t i = 0; i < fromFiles.hunks.size(); ++i) {
+            EXPECT_EQ(fromFiles.hunks[i].leftStart, fromLines.hunks[i].leftStart);
+            EXPECT_EQ(fromFiles.hunks[i].leftCount, fromLines.hunks[i].leftCount);
+            EXPECT_EQ(fromFiles.hunks[i].rightStart, fromLines.hunks[i].rightStart);
+            EXPECT_EQ(fromFiles.hunks[i].rightCount, fromLines.hunks[i].rightCount);
+        }
+    }
+}
+
 } // namespace bendiff::core::diff
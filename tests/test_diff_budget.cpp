@@ -0,0 +1,152 @@
+#include <diff/alignment.h>
+#include <diff/diff.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bendiff::core::diff {
+
+namespace {
+
+// Checks that the aligned rows walk both sides in order and only pair equal lines.
+void ExpectValidScript(const std::vector<std::string>& left,
+                       const std::vector<std::string>& right,
+                       const DiffResult& r)
+{
+    std::size_t nextLeft = 0;
+    std::size_t nextRight = 0;
+    for (const auto& row : BuildAlignedRows(r)) {
+        if (row.left) {
+            ASSERT_EQ(*row.left, nextLeft);
+            ++nextLeft;
+        }
+        if (row.right) {
+            ASSERT_EQ(*row.right, nextRight);
+            ++nextRight;
+        }
+        if (row.op == LineOp::Equal) {
+            ASSERT_TRUE(row.left && row.right);
+            ASSERT_EQ(left[*row.left], right[*row.right]);
+        }
+    }
+    EXPECT_EQ(nextLeft, left.size());
+    EXPECT_EQ(nextRight, right.size());
+}
+
+std::size_t EditCount(const DiffResult& r)
+{
+    std::size_t n = 0;
+    for (const auto& h : r.hunks) {
+        n += h.leftCount + h.rightCount;
+    }
+    return n;
+}
+
+std::vector<std::string> RandomLines(std::mt19937& rng, std::size_t count, int alphabet)
+{
+    std::uniform_int_distribution<int> pick(0, alphabet - 1);
+    std::vector<std::string> out;
+    out.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        out.push_back(std::string(1, static_cast<char>('a' + pick(rng))));
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(DiffBudget, UnlimitedByDefault)
+{
+    const std::vector<std::string> left = {"a", "b", "c"};
+    const std::vector<std::string> right = {"x", "y", "z"};
+
+    const auto r = DiffLines(left, right, WhitespaceMode::Exact);
+    EXPECT_FALSE(r.approximate);
+}
+
+TEST(DiffBudget, WithinBudgetIsExact)
+{
+    const std::vector<std::string> left = {"a", "b", "c", "d"};
+    const std::vector<std::string> right = {"a", "x", "c", "d"};
+
+    DiffOptions o;
+    o.maxEditCost = 2;
+    const auto bounded = DiffLines(left, right, WhitespaceMode::Exact, o);
+    const auto exact = DiffLines(left, right, WhitespaceMode::Exact);
+
+    EXPECT_FALSE(bounded.approximate);
+    ASSERT_EQ(bounded.hunks.size(), exact.hunks.size());
+    EXPECT_EQ(EditCount(bounded), EditCount(exact));
+}
+
+TEST(DiffBudget, EditCostCutOffStillProducesValidScripts)
+{
+    std::mt19937 rng(777);
+    std::uniform_int_distribution<std::size_t> len(0, 80);
+
+    for (int iter = 0; iter < 200; ++iter) {
+        const auto left = RandomLines(rng, len(rng), 2 + (iter % 6));
+        const auto right = RandomLines(rng, len(rng), 2 + (iter % 6));
+
+        for (const auto algorithm : {DiffAlgorithm::Myers, DiffAlgorithm::Histogram}) {
+            DiffOptions o;
+            o.algorithm = algorithm;
+            o.maxEditCost = 1 + static_cast<std::size_t>(iter % 4);
+
+            SCOPED_TRACE("iteration " + std::to_string(iter));
+            const auto r = DiffLines(left, right, WhitespaceMode::Exact, o);
+            ExpectValidScript(left, right, r);
+            EXPECT_GE(EditCount(r), EditCount(DiffLines(left, right, WhitespaceMode::Exact)));
+        }
+    }
+}
+
+TEST(DiffBudget, ExpiredTimeBudgetReportsRemainderAsReplaced)
+{
+    std::mt19937 rng(99);
+    const auto left = RandomLines(rng, 3'000, 4);
+    const auto right = RandomLines(rng, 3'000, 4);
+
+    DiffOptions o;
+    o.timeBudget = std::chrono::milliseconds(1);
+
+    const auto r = DiffLines(left, right, WhitespaceMode::Exact, o);
+    ExpectValidScript(left, right, r);
+}
+
+TEST(PerformanceSanity, UnrelatedFilesWithEditCostBudget)
+{
+    // Two large files with nothing in common: the exact search needs
+    // D = N + M steps over ever wider frontiers. With a cost budget the result
+    // is the trivial delete-everything/insert-everything script.
+    constexpr std::size_t kLineCount = 100'000;
+
+    std::vector<std::string> left;
+    std::vector<std::string> right;
+    left.reserve(kLineCount);
+    right.reserve(kLineCount);
+    for (std::size_t i = 0; i < kLineCount; ++i) {
+        left.push_back("left " + std::to_string(i));
+        right.push_back("right " + std::to_string(i));
+    }
+
+    DiffOptions o;
+    o.maxEditCost = 1'000;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const auto r = DiffLines(left, right, WhitespaceMode::Exact, o);
+    const auto t1 = std::chrono::steady_clock::now();
+    RecordProperty("bounded_ms",
+                   static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count()));
+
+    EXPECT_TRUE(r.approximate);
+    ExpectValidScript(left, right, r);
+    EXPECT_EQ(EditCount(r), 2 * kLineCount);
+}
+
+} // namespace bendiff::core::diff
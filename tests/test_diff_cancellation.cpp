@@ -0,0 +1,195 @@
+#include <diff/diff.h>
+#include <render/diff_render_model.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bendiff::core::diff {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Generous bound on the time from a stop request to the call returning. The
+// uncancelled diffs below take many seconds; a cancelled one should return
+// within a few search steps.
+constexpr auto kMaxCancelLatency = std::chrono::milliseconds(1'000);
+
+// Two 100k-line files drawn from a two-line alphabet: every line is far too
+// frequent to anchor on (so the histogram engine falls back to Myers) and the
+// edit distance is tens of thousands, so either engine takes far longer than
+// kMaxCancelLatency to complete.
+struct LargeInputs {
+    std::vector<std::string> left;
+    std::vector<std::string> right;
+};
+
+LargeInputs MakeLargeInputs()
+{
+    constexpr std::size_t kLineCount = 100'000;
+
+    std::mt19937 rng(2024);
+    std::bernoulli_distribution coin(0.5);
+
+    LargeInputs out;
+    out.left.reserve(kLineCount);
+    out.right.reserve(kLineCount);
+    for (std::size_t i = 0; i < kLineCount; ++i) {
+        out.left.push_back(coin(rng) ? "{" : "}");
+        out.right.push_back(coin(rng) ? "{" : "}");
+    }
+    return out;
+}
+
+long long Ms(Clock::duration d)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+}
+
+} // namespace
+
+TEST(DiffCancellation, StopBeforeStartReturnsCancelled)
+{
+    const std::vector<std::string> left = {"a", "b"};
+    const std::vector<std::string> right = {"a", "c"};
+
+    std::stop_source source;
+    source.request_stop();
+
+    DiffOptions o;
+    o.control.stop = source.get_token();
+
+    const auto r = DiffLines(left, right, WhitespaceMode::Exact, o);
+    EXPECT_TRUE(r.cancelled);
+    EXPECT_TRUE(r.hunks.empty());
+}
+
+TEST(DiffCancellation, ProgressIsMonotonicAndCompletes)
+{
+    std::vector<std::string> left;
+    std::vector<std::string> right;
+    for (int i = 0; i < 5'000; ++i) {
+        left.push_back("line " + std::to_string(i));
+        right.push_back((i % 7) == 0 ? "changed " + std::to_string(i) : left.back());
+    }
+
+    for (const auto algorithm : {DiffAlgorithm::Myers, DiffAlgorithm::Histogram}) {
+        std::vector<double> reports;
+        DiffOptions o;
+        o.algorithm = algorithm;
+        o.control.progress = [&](double fraction) { reports.push_back(fraction); };
+
+        const auto r = DiffLines(left, right, WhitespaceMode::Exact, o);
+        EXPECT_FALSE(r.cancelled);
+        ASSERT_FALSE(reports.empty());
+        for (std::size_t i = 1; i < reports.size(); ++i) {
+            EXPECT_LE(reports[i - 1], reports[i]);
+        }
+        EXPECT_GE(reports.front(), 0.0);
+        EXPECT_EQ(reports.back(), 1.0);
+    }
+}
+
+TEST(DiffCancellation, StopFromProgressCallbackOnLargeInput)
+{
+    const auto in = MakeLargeInputs();
+
+    std::stop_source source;
+    Clock::time_point stoppedAt;
+
+    DiffOptions o;
+    o.control.stop = source.get_token();
+    o.control.progress = [&](double fraction) {
+        if (fraction > 0.1 && !source.stop_requested()) {
+            stoppedAt = Clock::now();
+            source.request_stop();
+        }
+    };
+
+    const auto r = DiffLines(in.left, in.right, WhitespaceMode::Exact, o);
+    const auto latency = Clock::now() - stoppedAt;
+
+    EXPECT_TRUE(r.cancelled);
+    EXPECT_TRUE(r.hunks.empty());
+    EXPECT_LT(latency, kMaxCancelLatency) << Ms(latency) << " ms";
+}
+
+TEST(DiffCancellation, StopFromAnotherThreadOnLargeInput)
+{
+    const auto in = MakeLargeInputs();
+
+    for (const auto algorithm : {DiffAlgorithm::Myers, DiffAlgorithm::Histogram}) {
+        DiffResult r;
+        Clock::time_point finishedAt;
+
+        std::jthread worker([&](std::stop_token stop) {
+            DiffOptions o;
+            o.algorithm = algorithm;
+            o.control.stop = stop;
+            r = DiffLines(in.left, in.right, WhitespaceMode::Exact, o);
+            finishedAt = Clock::now();
+        });
+
+        // Let the search get well under way before abandoning it.
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        const auto stoppedAt = Clock::now();
+        worker.request_stop();
+        worker.join();
+
+        const auto latency = finishedAt - stoppedAt;
+        RecordProperty(algorithm == DiffAlgorithm::Myers ? "myers_cancel_ms" : "histogram_cancel_ms",
+                       static_cast<int>(Ms(latency)));
+
+        EXPECT_TRUE(r.cancelled);
+        EXPECT_LT(latency, kMaxCancelLatency) << Ms(latency) << " ms";
+    }
+}
+
+TEST(DiffCancellation, RenderBuildersStopOnRequest)
+{
+    std::vector<std::string> leftLines;
+    std::vector<std::string> rightLines;
+    for (int i = 0; i < 100'000; ++i) {
+        leftLines.push_back("line " + std::to_string(i));
+        rightLines.push_back((i % 1000) == 0 ? "changed " + std::to_string(i) : leftLines.back());
+    }
+    LoadedTextFile left;
+    LoadedTextFile right;
+    left.lines = TextLines(leftLines);
+    right.lines = TextLines(rightLines);
+    const auto d = DiffLines(left.lines, right.lines, WhitespaceMode::Exact);
+
+    for (const bool inlineMode : {false, true}) {
+        std::stop_source source;
+        int reports = 0;
+
+        WorkControl control;
+        control.stop = source.get_token();
+        control.progress = [&](double fraction) {
+            ++reports;
+            if (fraction > 0.25) {
+                source.request_stop();
+            }
+        };
+
+        const auto doc = inlineMode ? render::BuildInlineRender(left, right, d, control)
+                                    : render::BuildSideBySideRender(left, right, d, control);
+        EXPECT_TRUE(doc.cancelled);
+        EXPECT_TRUE(doc.blocks.empty());
+        EXPECT_GT(reports, 1);
+
+        const auto full = inlineMode ? render::BuildInlineRender(left, right, d)
+                                     : render::BuildSideBySideRender(left, right, d);
+        EXPECT_FALSE(full.cancelled);
+        EXPECT_FALSE(full.blocks.empty());
+    }
+}
+
+} // namespace bendiff::core::diff
@@ -79,4 +79,80 @@ TEST(AlignedRows, BuildsUnifiedRowStream)
     EXPECT_TRUE(rows[3].right.has_value());
 }
 
+TEST(AlignedRuns, CoverTheFilesInRunsAndExpandToTheRows)
+{
+    std::vector<std::string> left;
+    for (int i = 0; i < 1000; ++i) {
+        left.push_back("line " + std::to_string(i));
+    }
+    std::vector<std::string> right = left;
+    right[10] = "changed";
+    right.insert(right.begin() + 500, {"x", "y"});
+
+    const auto r = DiffLines(left, right, WhitespaceMode::Exact);
+    const auto runs = BuildAlignedRuns(r);
+
+    // equal, delete, insert, equal, insert, equal
+    ASSERT_EQ(runs.size(), 6u);
+    EXPECT_EQ(runs[0].op, LineOp::Equal);
+    EXPECT_EQ(runs[0].length, 10u);
+    EXPECT_EQ(runs[4].op, LineOp::Insert);
+    EXPECT_EQ(runs[4].rightStart, 500u);
+    EXPECT_EQ(runs[4].length, 2u);
+    EXPECT_EQ(runs[5].leftStart, 500u);
+    EXPECT_EQ(runs[5].rightStart, 502u);
+
+    std::vector<AlignedRow> expanded;
+    for (const auto& run : runs) {
+        for (std::size_t k = 0; k < run.length; ++k) {
+            expanded.push_back(RowInRun(run, k));
+        }
+    }
+    const auto rows = BuildAlignedRows(r);
+    ASSERT_EQ(expanded.size(), rows.size());
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        EXPECT_EQ(expanded[i].op, rows[i].op) << "row " << i;
+        EXPECT_EQ(expanded[i].left, rows[i].left) << "row " << i;
+        EXPECT_EQ(expanded[i].right, rows[i].right) << "row " << i;
+    }
+}
+
+TEST(AlignedRowView, RandomAccessMatchesTheBuiltRows)
+{
+    const std::vector<std::string> left = {"a", "b", "c", "d", "e", "f", "g"};
+    const std::vector<std::string> right = {"x", "a", "B", "c", "d", "f", "g", "z"};
+
+    const auto r = DiffLines(left, right, WhitespaceMode::Exact);
+    const auto rows = BuildAlignedRows(r);
+    const AlignedRowView view(r);
+
+    ASSERT_EQ(view.rowCount(), rows.size());
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        const auto row = view.row(i);
+        EXPECT_EQ(row.op, rows[i].op) << "row " << i;
+        EXPECT_EQ(row.left, rows[i].left) << "row " << i;
+        EXPECT_EQ(row.right, rows[i].right) << "row " << i;
+
+        if (rows[i].left) {
+            EXPECT_EQ(view.rowForLeftLine(*rows[i].left), i);
+        }
+        if (rows[i].right) {
+            EXPECT_EQ(view.rowForRightLine(*rows[i].right), i);
+        }
+    }
+
+    EXPECT_EQ(view.rowForLeftLine(left.size()), std::nullopt);
+    EXPECT_EQ(view.rowForRightLine(right.size()), std::nullopt);
+}
+
+TEST(AlignedRowView, EmptyDiffHasNoRows)
+{
+    const AlignedRowView view(DiffLines(std::vector<std::string>{}, std::vector<std::string>{}, WhitespaceMode::Exact));
+    EXPECT_EQ(view.rowCount(), 0u);
+    EXPECT_EQ(view.rowForLeftLine(0), std::nullopt);
+    EXPECT_EQ(view.rowForRightLine(0), std::nullopt);
+
+    EXPECT_EQ(AlignedRowView().rowCount(), 0u);
+}
+
 } // namespace bendiff::core::diff
@@ -110,7 +110,7 @@ std::string SerializeDiffResult(const DiffResult& r)
         const auto& h = r.hunks[i];
         out << "HUNK " << i << " L " << h.leftStart << " " << h.leftCount << " R " << h.rightStart << " "
             << h.rightCount << "\n";
-        for (const auto& dl : h.lines) {
+        for (const auto& dl : ExpandHunkLines(h)) {
             out << "  " << ToString(dl.op) << " L " << IndexOrDash(dl.leftIndex, DiffLine::npos) << " R "
                 << IndexOrDash(dl.rightIndex, DiffLine::npos) << "\n";
         }
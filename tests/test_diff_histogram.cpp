@@ -0,0 +1,186 @@
+#include <diff/alignment.h>
+#include <diff/diff.h>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <initializer_list>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bendiff::core::diff {
+
+namespace {
+
+DiffResult HistogramDiff(const std::vector<std::string>& left, const std::vector<std::string>& right)
+{
+    DiffOptions o;
+    o.algorithm = DiffAlgorithm::Histogram;
+    return DiffLines(left, right, WhitespaceMode::Exact, o);
+}
+
+std::vector<LineOp> OpsOnly(const DiffResult& r)
+{
+    std::vector<LineOp> out;
+    for (const auto& h : r.hunks) {
+        for (const auto& l : ExpandHunkLines(h)) {
+            out.push_back(l.op);
+        }
+    }
+    return out;
+}
+
+// Checks that the aligned rows walk both sides in order and only pair equal lines.
+void ExpectValidScript(const std::vector<std::string>& left,
+                       const std::vector<std::string>& right,
+                       const DiffResult& r)
+{
+    std::size_t nextLeft = 0;
+    std::size_t nextRight = 0;
+    for (const auto& row : BuildAlignedRows(r)) {
+        if (row.left) {
+            ASSERT_EQ(*row.left, nextLeft);
+            ++nextLeft;
+        }
+        if (row.right) {
+            ASSERT_EQ(*row.right, nextRight);
+            ++nextRight;
+        }
+        if (row.op == LineOp::Equal) {
+            ASSERT_TRUE(row.left && row.right);
+            ASSERT_EQ(left[*row.left], right[*row.right]);
+        }
+    }
+    EXPECT_EQ(nextLeft, left.size());
+    EXPECT_EQ(nextRight, right.size());
+}
+
+} // namespace
+
+TEST(HistogramDiff, BasicCases)
+{
+    const std::vector<std::string> empty;
+    const std::vector<std::string> ab = {"a", "b"};
+
+    EXPECT_EQ(OpsOnly(HistogramDiff(empty, ab)), (std::vector<LineOp>{LineOp::Insert, LineOp::Insert}));
+    EXPECT_EQ(OpsOnly(HistogramDiff(ab, empty)), (std::vector<LineOp>{LineOp::Delete, LineOp::Delete}));
+    EXPECT_TRUE(HistogramDiff(ab, ab).hunks.empty());
+
+    const auto r = HistogramDiff({"a", "b", "c"}, {"a", "x", "c"});
+    EXPECT_EQ(OpsOnly(r), (std::vector<LineOp>{LineOp::Delete, LineOp::Insert}));
+}
+
+TEST(HistogramDiff, AnchorsOnUniqueLinesInsteadOfBraces)
+{
+    // One function is removed and another appended. Myers pairs up the shared
+    // braces/blank lines and reports four one-line replacements; the histogram
+    // engine anchors on the unique lines and reports one five-line deletion and
+    // one five-line insertion.
+    const auto fn = [](const std::string& name, const std::string& value) {
+        return std::vector<std::string>{"int " + name + "()", "{", "    return " + value + ";", "}", ""};
+    };
+    const auto concat = [](std::initializer_list<std::vector<std::string>> parts) {
+        std::vector<std::string> out;
+        for (const auto& p : parts) {
+            out.insert(out.end(), p.begin(), p.end());
+        }
+        return out;
+    };
+
+    const auto left = concat({fn("f0", "0"), fn("f1", "1"), fn("f2", "2")});
+    const auto right = concat({fn("f0", "0"), fn("f2", "2"), fn("f8", "8")});
+
+    const auto r = HistogramDiff(left, right);
+    ExpectValidScript(left, right, r);
+    ASSERT_EQ(r.hunks.size(), 2u);
+    EXPECT_EQ(r.hunks[0].leftStart, 5u);
+    EXPECT_EQ(r.hunks[0].leftCount, 5u);
+    EXPECT_EQ(r.hunks[0].rightCount, 0u);
+    EXPECT_EQ(r.hunks[1].leftCount, 0u);
+    EXPECT_EQ(r.hunks[1].rightCount, 5u);
+
+    const auto myers = DiffLines(left, right, WhitespaceMode::Exact);
+    EXPECT_EQ(myers.hunks.size(), 4u);
+}
+
+TEST(HistogramDiff, FrequentLinesOnlyFallBackToMyers)
+{
+    // The only lines common to both sides occur far too often to anchor on,
+    // so the region falls back to Myers.
+    std::vector<std::string> left(200, "x");
+    left.insert(left.begin(), "left head");
+    left.push_back("left tail");
+
+    std::vector<std::string> right(200, "x");
+    right.insert(right.begin() + 100, "y");
+    right.insert(right.begin(), "right head");
+    right.push_back("right tail");
+
+    const auto r = HistogramDiff(left, right);
+    ExpectValidScript(left, right, r);
+    ASSERT_EQ(r.hunks.size(), 3u);
+    EXPECT_EQ(r.hunks[1].leftCount, 0u);
+    EXPECT_EQ(r.hunks[1].rightStart, 101u);
+    EXPECT_EQ(r.hunks[1].rightCount, 1u);
+}
+
+TEST(HistogramDiff, RandomInputsProduceValidScripts)
+{
+    std::mt19937 rng(424242);
+    std::uniform_int_distribution<std::size_t> len(0, 60);
+
+    for (int iter = 0; iter < 300; ++iter) {
+        const int alphabet = 1 + (iter % 12);
+        std::uniform_int_distribution<int> pick(0, alphabet - 1);
+
+        auto make = [&] {
+            std::vector<std::string> v(len(rng));
+            for (auto& s : v) {
+                s = std::string(1, static_cast<char>('a' + pick(rng)));
+            }
+            return v;
+        };
+        const auto left = make();
+        const auto right = make();
+
+        SCOPED_TRACE("iteration " + std::to_string(iter));
+        ExpectValidScript(left, right, HistogramDiff(left, right));
+    }
+}
+
+TEST(PerformanceSanity, HistogramRepeatedLinesCompletes)
+{
+    // Same shape as ModerateInputCompletesAndShapesAreConsistent: mostly unique
+    // lines with a repeated "COMMON" line every 100 lines, plus small edits.
+    constexpr std::size_t kLineCount = 10'000;
+
+    std::vector<std::string> left;
+    left.reserve(kLineCount);
+    for (std::size_t i = 0; i < kLineCount; ++i) {
+        left.push_back((i % 100) == 0 ? std::string("COMMON") : "line " + std::to_string(i));
+    }
+
+    std::vector<std::string> right;
+    right.reserve(kLineCount + 8);
+    right.push_back("header insert");
+    for (std::size_t i = 0; i < kLineCount; ++i) {
+        if (i == 5'000) {
+            continue;
+        }
+        if (i == 1234 || i == 4321 || i == 8765) {
+            right.push_back("replaced " + std::to_string(i));
+            continue;
+        }
+        right.push_back(left[i]);
+        if (i == 2500) {
+            right.push_back("mid insert");
+        }
+    }
+
+    const auto r = HistogramDiff(left, right);
+    ExpectValidScript(left, right, r);
+    EXPECT_EQ(r.hunks.size(), 6u);
+}
+
+} // namespace bendiff::core::diff
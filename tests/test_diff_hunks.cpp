@@ -21,10 +21,11 @@ TEST(Hunks, SingleIsolatedInsertionProducesOneHunk)
     EXPECT_EQ(h.rightStart, 2u);
     EXPECT_EQ(h.rightCount, 1u);
 
-    ASSERT_EQ(h.lines.size(), 1u);
-    EXPECT_EQ(h.lines[0].op, LineOp::Insert);
-    EXPECT_EQ(h.lines[0].rightIndex, 2u);
-    EXPECT_EQ(h.lines[0].leftIndex, DiffLine::npos);
+    const auto lines = ExpandHunkLines(h);
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_EQ(lines[0].op, LineOp::Insert);
+    EXPECT_EQ(lines[0].rightIndex, 2u);
+    EXPECT_EQ(lines[0].leftIndex, DiffLine::npos);
 }
 
 TEST(Hunks, TwoSeparatedChangeRegionsProduceTwoHunks)
@@ -41,13 +42,67 @@ TEST(Hunks, TwoSeparatedChangeRegionsProduceTwoHunks)
     EXPECT_EQ(r.hunks[1].rightStart, 4u);
 
     // Each region is a single replace -> Delete+Insert (with no Equal lines in the hunk).
-    ASSERT_EQ(r.hunks[0].lines.size(), 2u);
-    EXPECT_EQ(r.hunks[0].lines[0].op, LineOp::Delete);
-    EXPECT_EQ(r.hunks[0].lines[1].op, LineOp::Insert);
+    const auto lines0 = ExpandHunkLines(r.hunks[0]);
+    const auto lines1 = ExpandHunkLines(r.hunks[1]);
+    ASSERT_EQ(lines0.size(), 2u);
+    EXPECT_EQ(lines0[0].op, LineOp::Delete);
+    EXPECT_EQ(lines0[1].op, LineOp::Insert);
 
-    ASSERT_EQ(r.hunks[1].lines.size(), 2u);
-    EXPECT_EQ(r.hunks[1].lines[0].op, LineOp::Delete);
-    EXPECT_EQ(r.hunks[1].lines[1].op, LineOp::Insert);
+    ASSERT_EQ(lines1.size(), 2u);
+    EXPECT_EQ(lines1[0].op, LineOp::Delete);
+    EXPECT_EQ(lines1[1].op, LineOp::Insert);
+}
+
+TEST(Hunks, IndicesReferToFullInputsAfterCommonPrefixSuffixTrim)
+{
+    // Long identical head and tail around a single replaced line.
+    std::vector<std::string> left;
+    for (int i = 0; i < 1000; ++i) {
+        left.push_back("line " + std::to_string(i));
+    }
+    std::vector<std::string> right = left;
+    right[500] = "changed";
+    right.insert(right.begin() + 700, "added");
+
+    const auto r = DiffLines(left, right, WhitespaceMode::Exact);
+    ASSERT_EQ(r.hunks.size(), 2u);
+
+    EXPECT_EQ(r.hunks[0].leftStart, 500u);
+    EXPECT_EQ(r.hunks[0].rightStart, 500u);
+    const auto lines0 = ExpandHunkLines(r.hunks[0]);
+    ASSERT_EQ(lines0.size(), 2u);
+    EXPECT_EQ(lines0[0].op, LineOp::Delete);
+    EXPECT_EQ(lines0[0].leftIndex, 500u);
+    EXPECT_EQ(lines0[1].op, LineOp::Insert);
+    EXPECT_EQ(lines0[1].rightIndex, 500u);
+
+    EXPECT_EQ(r.hunks[1].leftStart, 700u);
+    EXPECT_EQ(r.hunks[1].rightStart, 700u);
+    const auto lines1 = ExpandHunkLines(r.hunks[1]);
+    ASSERT_EQ(lines1.size(), 1u);
+    EXPECT_EQ(lines1[0].op, LineOp::Insert);
+    EXPECT_EQ(lines1[0].rightIndex, 700u);
+}
+
+TEST(Hunks, ConsecutiveLinesWithTheSameOpShareOneRun)
+{
+    const std::vector<std::string> left = {"a", "b", "c", "d", "e"};
+    const std::vector<std::string> right = {"a", "X", "Y", "e"};
+
+    const auto r = DiffLines(left, right, WhitespaceMode::Exact);
+    ASSERT_EQ(r.hunks.size(), 1u);
+
+    const auto& h = r.hunks[0];
+    ASSERT_EQ(h.runs.size(), 2u);
+    EXPECT_EQ(h.runs[0].op, LineOp::Delete);
+    EXPECT_EQ(h.runs[0].length, 3u);
+    EXPECT_EQ(h.runs[1].op, LineOp::Insert);
+    EXPECT_EQ(h.runs[1].length, 2u);
+
+    const auto lines = ExpandHunkLines(h);
+    ASSERT_EQ(lines.size(), 5u);
+    EXPECT_EQ(lines[2].leftIndex, 3u);
+    EXPECT_EQ(lines[4].rightIndex, 2u);
 }
 
 } // namespace bendiff::core::diff
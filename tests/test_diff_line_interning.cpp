@@ -0,0 +1,70 @@
+#include <diff/line_interning.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bendiff::core::diff {
+
+TEST(LineInterning, EqualKeysShareIdsAcrossSides)
+{
+    const std::vector<std::string> left = {"a", "b", "a"};
+    const std::vector<std::string> right = {"b", "c", "a"};
+
+    const auto ids = InternLines(left, right, WhitespaceMode::Exact);
+
+    EXPECT_EQ(ids.left, (std::vector<std::uint32_t>{0, 1, 0}));
+    EXPECT_EQ(ids.right, (std::vector<std::uint32_t>{1, 2, 0}));
+    EXPECT_EQ(ids.distinctCount, 3u);
+}
+
+TEST(LineInterning, WhitespaceModeDecidesEquality)
+{
+    const std::vector<std::string> left = {"foo", "f o o"};
+    const std::vector<std::string> right = {"foo \t"};
+
+    const auto exact = InternLines(left, right, WhitespaceMode::Exact);
+    EXPECT_EQ(exact.distinctCount, 3u);
+
+    const auto trailing = InternLines(left, right, WhitespaceMode::IgnoreTrailing);
+    EXPECT_EQ(trailing.right[0], trailing.left[0]);
+    EXPECT_EQ(trailing.distinctCount, 2u);
+
+    const auto all = InternLines(left, right, WhitespaceMode::IgnoreAll);
+    EXPECT_EQ(all.left[1], all.left[0]);
+    EXPECT_EQ(all.right[0], all.left[0]);
+    EXPECT_EQ(all.distinctCount, 1u);
+}
+
+TEST(LineInterning, HashedMatchesKeyedInterning)
+{
+    const std::vector<std::string> left = {"foo", "f o o", "bar", "foo", ""};
+    const std::vector<std::string> right = {"foo \t", "bar", "baz", " "};
+
+    for (const auto mode : {WhitespaceMode::Exact, WhitespaceMode::IgnoreTrailing, WhitespaceMode::IgnoreAll}) {
+        const auto keyed = InternLines(left, right, mode);
+        const auto hashed = InternLines(TextLines(left), TextLines(right), mode);
+        EXPECT_EQ(hashed.left, keyed.left);
+        EXPECT_EQ(hashed.right, keyed.right);
+        EXPECT_EQ(hashed.distinctCount, keyed.distinctCount);
+    }
+}
+
+TEST(LineInterning, HashCollisionsAreResolvedByKey)
+{
+    // Every line gets the same hash: IDs must still follow key equality.
+    const TextLines left = {"a", "b", "a"};
+    const TextLines right = {"b", "c", "a"};
+    const std::vector<std::uint64_t> leftHashes(left.size(), 0);
+    const std::vector<std::uint64_t> rightHashes(right.size(), 0);
+
+    const auto ids = InternLines(left, leftHashes, right, rightHashes, WhitespaceMode::Exact);
+
+    EXPECT_EQ(ids.left, (std::vector<std::uint32_t>{0, 1, 0}));
+    EXPECT_EQ(ids.right, (std::vector<std::uint32_t>{1, 2, 0}));
+    EXPECT_EQ(ids.distinctCount, 3u);
+}
+
+} // namespace bendiff::core::diff
@@ -0,0 +1,179 @@
+#include <diff/diff.h>
+#include <diff/line_interning.h>
+#include <diff/myers.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bendiff::core::diff {
+
+namespace {
+
+std::vector<DiffLine> FlattenLines(const DiffResult& r)
+{
+    std::vector<DiffLine> out;
+    for (const auto& h : r.hunks) {
+        const auto lines = ExpandHunkLines(h);
+        out.insert(out.end(), lines.begin(), lines.end());
+    }
+    return out;
+}
+
+void ExpectSameResult(const DiffResult& a, const DiffResult& b)
+{
+    ASSERT_EQ(a.hunks.size(), b.hunks.size());
+    for (std::size_t i = 0; i < a.hunks.size(); ++i) {
+        EXPECT_EQ(a.hunks[i].leftStart, b.hunks[i].leftStart) << "hunk " << i;
+        EXPECT_EQ(a.hunks[i].leftCount, b.hunks[i].leftCount) << "hunk " << i;
+        EXPECT_EQ(a.hunks[i].rightStart, b.hunks[i].rightStart) << "hunk " << i;
+        EXPECT_EQ(a.hunks[i].rightCount, b.hunks[i].rightCount) << "hunk " << i;
+    }
+
+    const auto linesA = FlattenLines(a);
+    const auto linesB = FlattenLines(b);
+    ASSERT_EQ(linesA.size(), linesB.size());
+    for (std::size_t i = 0; i < linesA.size(); ++i) {
+        EXPECT_EQ(linesA[i].op, linesB[i].op) << "line " << i;
+        EXPECT_EQ(linesA[i].leftIndex, linesB[i].leftIndex) << "line " << i;
+        EXPECT_EQ(linesA[i].rightIndex, linesB[i].rightIndex) << "line " << i;
+    }
+}
+
+std::vector<std::string> RandomLines(std::mt19937& rng, std::size_t count, int alphabet)
+{
+    std::uniform_int_distribution<int> pick(0, alphabet - 1);
+    std::vector<std::string> out;
+    out.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        out.push_back(std::string(1, static_cast<char>('a' + pick(rng))));
+    }
+    return out;
+}
+
+DiffOptions ForceLinearSpace()
+{
+    DiffOptions o;
+    o.maxTraceBytes = 0;
+    return o;
+}
+
+} // namespace
+
+TEST(LinearSpaceMyers, MatchesFullTraceOnRandomInputs)
+{
+    // Small alphabets produce many repeated lines, which is where tie-breaking
+    // in the backtrack matters most.
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<std::size_t> len(0, 40);
+
+    for (int iter = 0; iter < 300; ++iter) {
+        const int alphabet = 2 + (iter % 5);
+        const auto left = RandomLines(rng, len(rng), alphabet);
+        const auto right = RandomLines(rng, len(rng), alphabet);
+
+        const auto full = DiffLines(left, right, WhitespaceMode::Exact);
+        const auto linear = DiffLines(left, right, WhitespaceMode::Exact, ForceLinearSpace());
+
+        SCOPED_TRACE("iteration " + std::to_string(iter));
+        ExpectSameResult(full, linear);
+    }
+}
+
+TEST(LinearSpaceMyers, EdgeCasesMatchFullTrace)
+{
+    const std::vector<std::string> empty;
+    const std::vector<std::string> ab = {"a", "b"};
+    const std::vector<std::string> cd = {"c", "d"};
+
+    ExpectSameResult(DiffLines(empty, empty, WhitespaceMode::Exact),
+                     DiffLines(empty, empty, WhitespaceMode::Exact, ForceLinearSpace()));
+    ExpectSameResult(DiffLines(empty, ab, WhitespaceMode::Exact),
+                     DiffLines(empty, ab, WhitespaceMode::Exact, ForceLinearSpace()));
+    ExpectSameResult(DiffLines(ab, empty, WhitespaceMode::Exact),
+                     DiffLines(ab, empty, WhitespaceMode::Exact, ForceLinearSpace()));
+    ExpectSameResult(DiffLines(ab, ab, WhitespaceMode::Exact),
+                     DiffLines(ab, ab, WhitespaceMode::Exact, ForceLinearSpace()));
+    ExpectSameResult(DiffLines(ab, cd, WhitespaceMode::Exact),
+                     DiffLines(ab, cd, WhitespaceMode::Exact, ForceLinearSpace()));
+}
+
+TEST(PerformanceSanity, LinearSpaceLargeGeneratedFile)
+{
+    // Benchmark-style sanity check for the linear-space path: a large generated
+    // file with scattered edits. With a full-width trace per D-step this input
+    // would need (2 * (N + M) + 1) * 8 bytes * D ~= 6 GB; the recorded
+    // frontier trace needs ~D^2 * 4 bytes, and the linear-space backtrack keeps
+    // only O(log D) frontiers plus one small leaf segment alive.
+    //
+    // Wall time and peak trace bytes of both variants are recorded as test
+    // properties. Timing is not asserted, to keep the test stable across
+    // machines/configs; memory is.
+    constexpr std::size_t kLineCount = 200'000;
+    constexpr std::size_t kEditStride = 211;
+
+    std::vector<std::string> left;
+    left.reserve(kLineCount);
+    for (std::size_t i = 0; i < kLineCount; ++i) {
+        left.push_back("generated line " + std::to_string(i));
+    }
+
+    // Every edit site is far enough from the next to form its own hunk.
+    std::vector<std::string> right;
+    right.reserve(kLineCount + kLineCount / kEditStride);
+    std::size_t editSites = 0;
+    for (std::size_t i = 0; i < kLineCount; ++i) {
+        if ((i % kEditStride) == 7) {
+            right.push_back("edited " + std::to_string(i));
+            ++editSites;
+            continue;
+        }
+        right.push_back(left[i]);
+        if ((i % kEditStride) == 100) {
+            right.push_back("inserted " + std::to_string(i));
+            ++editSites;
+        }
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const auto linear = DiffLines(left, right, WhitespaceMode::Exact, ForceLinearSpace());
+    const auto t1 = std::chrono::steady_clock::now();
+    const auto full = DiffLines(left, right, WhitespaceMode::Exact);
+    const auto t2 = std::chrono::steady_clock::now();
+
+    const auto ms = [](auto d) {
+        return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(d).count());
+    };
+    RecordProperty("linear_space_ms", ms(t1 - t0));
+    RecordProperty("full_trace_ms", ms(t2 - t1));
+
+    EXPECT_EQ(linear.leftLineCount, left.size());
+    EXPECT_EQ(linear.rightLineCount, right.size());
+    EXPECT_EQ(linear.hunks.size(), editSites);
+    ExpectSameResult(full, linear);
+
+    // Memory: run the engine directly on the whole input (no affix trimming)
+    // to read its trace meter.
+    const auto ids = InternLines(left, right, WhitespaceMode::Exact);
+    const auto defaults = DiffOptions{};
+    SearchLimits linearLimits;
+    linearLimits.maxTraceBytes = 0;
+    SearchLimits fullLimits;
+    fullLimits.maxTraceBytes = defaults.maxTraceBytes;
+    const auto linearScript = MyersDiffOps(ids.left, ids.right, linearLimits);
+    const auto fullScript = MyersDiffOps(ids.left, ids.right, fullLimits);
+    RecordProperty("linear_space_peak_trace_bytes", std::to_string(linearScript.peakTraceBytes));
+    RecordProperty("full_trace_peak_trace_bytes", std::to_string(fullScript.peakTraceBytes));
+
+    EXPECT_EQ(linearScript.ops.size(), fullScript.ops.size());
+    EXPECT_GT(linearScript.peakTraceBytes, 0u);
+    EXPECT_LE(linearScript.peakTraceBytes, defaults.maxTraceBytes);
+    EXPECT_LE(fullScript.peakTraceBytes, defaults.maxTraceBytes);
+    EXPECT_LT(linearScript.peakTraceBytes, fullScript.peakTraceBytes);
+}
+
+} // namespace bendiff::core::diff
@@ -13,7 +13,7 @@ std::vector<LineOp> OpsOnly(const DiffResult& r)
 {
     std::vector<LineOp> out;
     for (const auto& h : r.hunks) {
-        for (const auto& l : h.lines) {
+        for (const auto& l : ExpandHunkLines(h)) {
             out.push_back(l.op);
         }
     }
@@ -67,6 +67,37 @@ std::vector<std::string> Simplify(const RenderDocument& doc)
     return out;
 }
 
+// "<firstRow>+<rowCount><op>" per change run.
+std::vector<std::string> Runs(const RenderDocument& doc)
+{
+    std::vector<std::string> out;
+    for (const auto& run : doc.changeRuns) {
+        out.push_back(std::to_string(run.firstRow) + "+" + std::to_string(run.rowCount) + OpChar(run.op));
+    }
+    return out;
+}
+
+// Change runs recomputed row by row, for cross-checking the builders.
+std::vector<std::string> RunsFromRows(const RenderDocument& doc)
+{
+    RenderDocument scratch;
+    std::size_t row = 0;
+    for (const auto& block : doc.blocks) {
+        for (const auto& line : block.lines) {
+            if (line.op != bendiff::core::diff::LineOp::Equal) {
+                auto& runs = scratch.changeRuns;
+                if (!runs.empty() && runs.back().op == line.op && runs.back().firstRow + runs.back().rowCount == row) {
+                    ++runs.back().rowCount;
+                } else {
+                    runs.push_back(RenderRowRun{.firstRow = row, .rowCount = 1, .op = line.op});
+                }
+            }
+            ++row;
+        }
+    }
+    return Runs(scratch);
+}
+
 std::vector<RenderBlockSide> BlockSides(const RenderDocument& doc)
 {
     std::vector<RenderBlockSide> out;
@@ -351,4 +382,185 @@ TEST(DiffRenderModel, InlineIgnoreTrailingWhitespaceCanMakeLinesEqual)
                               }));
 }
 
+TEST(DiffRenderModel, ChangeRunsGroupConsecutiveRowsWithTheSameOp)
+{
+    bendiff::core::LoadedTextFile left;
+    left.status = bendiff::core::LoadStatus::Ok;
+    left.lines = {"a", "b", "c", "d", "e", "f", "g"};
+
+    bendiff::core::LoadedTextFile right;
+    right.status = bendiff::core::LoadStatus::Ok;
+    right.lines = {"a", "B", "c", "d", "x", "y", "f", "g", "z"};
+
+    const auto d = bendiff::core::diff::DiffLines(left.lines, right.lines, bendiff::core::diff::WhitespaceMode::Exact);
+
+    const auto inlineDoc = BuildInlineRender(left, right, d);
+    EXPECT_EQ(Runs(inlineDoc), (std::vector<std::string>{"1+1-", "2+1+", "5+1-", "6+2+", "10+1+"}));
+    EXPECT_EQ(Runs(inlineDoc), RunsFromRows(inlineDoc));
+
+    const auto sbsDoc = BuildSideBySideRender(left, right, d);
+    EXPECT_EQ(Runs(sbsDoc), RunsFromRows(sbsDoc));
+}
+
+TEST(DiffRenderModel, ChangeRunsForAddedOrDeletedFileAreOneRun)
+{
+    bendiff::core::LoadedTextFile present;
+    present.status = bendiff::core::LoadStatus::Ok;
+    present.lines = {"a", "b", "c"};
+
+    bendiff::core::LoadedTextFile missing;
+    missing.status = bendiff::core::LoadStatus::NotFound;
+
+    const bendiff::core::diff::DiffResult d;
+    EXPECT_EQ(Runs(BuildInlineRender(present, missing, d)), (std::vector<std::string>{"0+3-"}));
+    EXPECT_EQ(Runs(BuildSideBySideRender(missing, present, d)), (std::vector<std::string>{"0+3+"}));
+}
+
+TEST(DiffRenderModel, LineTextReferencesTheSharedLineStore)
+{
+    std::optional<RenderDocument> doc;
+    {
+        bendiff::core::LoadedTextFile left;
+        left.status = bendiff::core::LoadStatus::Ok;
+        left.lines = {"a", "b"};
+
+        bendiff::core::LoadedTextFile right;
+        right.status = bendiff::core::LoadStatus::Ok;
+        right.lines = {"a", "X", "b"};
+
+        const auto d = bendiff::core::diff::DiffLines(left.lines, right.lines, bendiff::core::diff::WhitespaceMode::Exact);
+        doc = BuildSideBySideRender(left, right, d);
+
+        const auto& lines = doc->blocks[0].lines;
+        EXPECT_EQ(lines[0].leftText.data(), left.lines[0].data());
+        EXPECT_EQ(lines[1].rightText.data(), right.lines[1].data());
+    }
+
+    // The document keeps the line stores alive after the files are gone.
+    const auto& lines = doc->blocks[0].lines;
+    EXPECT_EQ(lines[0].leftText, "a");
+    EXPECT_EQ(lines[1].rightText, "X");
+    EXPECT_EQ(lines[2].rightText, "b");
+}
+
+TEST(DiffRenderModel, LazyRenderRowsMatchTheBuiltRows)
+{
+    bendiff::core::LoadedTextFile left;
+    left.status = bendiff::core::LoadStatus::Ok;
+    left.lines = {"a", "b", "c", "d", "e", "f", "g"};
+
+    bendiff::core::LoadedTextFile right;
+    right.status = bendiff::core::LoadStatus::Ok;
+    right.lines = {"a", "B", "c", "d", "x", "y", "f", "g", "z"};
+
+    bendiff::core::LoadedTextFile missing;
+    missing.status = bendiff::core::LoadStatus::NotFound;
+
+    const auto d = bendiff::core::diff::DiffLines(left.lines, right.lines, bendiff::core::diff::WhitespaceMode::Exact);
+    const bendiff::core::diff::DiffResult none;
+
+    const auto expectSame = [](const RenderDocument& built, const RenderDocument& lazy) {
+        EXPECT_TRUE(lazy.blocks.empty());
+        EXPECT_EQ(Runs(lazy), Runs(built));
+
+        std::vector<RenderLine> rows;
+        for (const auto& block : built.blocks) {
+            rows.insert(rows.end(), block.lines.begin(), block.lines.end());
+        }
+        ASSERT_EQ(lazy.rows.rowCount(), rows.size());
+        ASSERT_EQ(built.rows.rowCount(), rows.size());
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            const auto line = RenderRowAt(lazy, i);
+            EXPECT_EQ(line.op, rows[i].op) << "row " << i;
+            EXPECT_EQ(line.leftLine, rows[i].leftLine) << "row " << i;
+            EXPECT_EQ(line.rightLine, rows[i].rightLine) << "row " << i;
+            EXPECT_EQ(line.leftText, rows[i].leftText) << "row " << i;
+            EXPECT_EQ(line.rightText, rows[i].rightText) << "row " << i;
+        }
+    };
+
+    expectSame(BuildSideBySideRender(left, right, d), BuildLazyRender(left, right, d));
+    expectSame(BuildInlineRender(left, right, d), BuildLazyRender(left, right, d));
+    expectSame(BuildInlineRender(left, missing, none), BuildLazyRender(left, missing, none));
+    expectSame(BuildSideBySideRender(missing, right, none), BuildLazyRender(missing, right, none));
+}
+
+TEST(DiffRenderModel, HunkRowsCoverEachHunksChangedRows)
+{
+    bendiff::core::LoadedTextFile left;
+    left.status = bendiff::core::LoadStatus::Ok;
+    left.lines = {"a", "b", "c", "d", "e", "f", "g"};
+
+    bendiff::core::LoadedTextFile right;
+    right.status = bendiff::core::LoadStatus::Ok;
+    right.lines = {"x", "a", "B", "c", "d", "f", "g", "z"};
+
+    const auto d = bendiff::core::diff::DiffLines(left.lines, right.lines, bendiff::core::diff::WhitespaceMode::Exact);
+    ASSERT_EQ(d.hunks.size(), 4u);
+
+    for (const auto& doc : {BuildInlineRender(left, right, d), BuildSideBySideRender(left, right, d), BuildLazyRender(left, right, d)}) {
+        ASSERT_EQ(doc.hunkRows.size(), d.hunks.size());
+
+        // Every changed row belongs to exactly the hunk the index says.
+        std::size_t hunk = 0;
+        for (std::size_t row = 0; row < doc.rows.rowCount(); ++row) {
+            const auto line = RenderRowAt(doc, row);
+            const auto at = bendiff::core::navigation::HunkAtRow(doc.hunkRows, row);
+            if (line.op == bendiff::core::diff::LineOp::Equal) {
+                EXPECT_EQ(at, std::nullopt) << "row " << row;
+                continue;
+            }
+            ASSERT_TRUE(at.has_value()) << "row " << row;
+            const auto& h = d.hunks[*at];
+            if (line.leftLine) {
+                EXPECT_GE(*line.leftLine - 1, h.leftStart);
+                EXPECT_LT(*line.leftLine - 1, h.leftStart + h.leftCount);
+            } else {
+                EXPECT_GE(*line.rightLine - 1, h.rightStart);
+                EXPECT_LT(*line.rightLine - 1, h.rightStart + h.rightCount);
+            }
+            EXPECT_GE(*at, hunk);
+            hunk = *at;
+        }
+    }
+}
+
+TEST(DiffRenderModel, DisplayColumnsExpandTabsToTabStops)
+{
+    EXPECT_EQ(DisplayColumns(""), 0u);
+    EXPECT_EQ(DisplayColumns("abc"), 3u);
+
+    // Each tab advances to the next multiple of the tab stop, so a line of
+    // tabs is far wider than its byte count.
+    EXPECT_EQ(DisplayColumns("\t"), kTabStopColumns);
+    EXPECT_EQ(DisplayColumns("ab\tc"), kTabStopColumns + 1);
+    EXPECT_EQ(DisplayColumns("abcdefgh\t"), 2 * kTabStopColumns);
+    const std::string tabHeavy = std::string(12, '\t') + "return value;";
+    EXPECT_EQ(DisplayColumns(tabHeavy), 12 * kTabStopColumns + 13);
+    EXPECT_GT(DisplayColumns(tabHeavy), tabHeavy.size());
+    EXPECT_EQ(DisplayColumns("\t\tx", 4), 9u);
+
+    // Multi-byte UTF-8 counts one column per code point.
+    EXPECT_EQ(DisplayColumns("h\xC3\xA9llo"), 5u);
+    EXPECT_EQ(DisplayColumns("\xE2\x82\xAC\t"), kTabStopColumns);
+}
+
+TEST(DiffRenderModel, BuildersMeasureEachSidesWidestLine)
+{
+    bendiff::core::LoadedTextFile left;
+    left.status = bendiff::core::LoadStatus::Ok;
+    left.lines = {"a long line without tabs", "\t\t\tx", "short"};
+
+    bendiff::core::LoadedTextFile right;
+    right.status = bendiff::core::LoadStatus::Ok;
+    right.lines = {"a", "h\xC3\xA9llo"};
+
+    const auto d = bendiff::core::diff::DiffLines(left.lines, right.lines, bendiff::core::diff::WhitespaceMode::Exact);
+    for (const auto& doc : {BuildInlineRender(left, right, d), BuildSideBySideRender(left, right, d), BuildLazyRender(left, right, d)}) {
+        // The short tabbed line is the widest as drawn.
+        EXPECT_EQ(doc.leftColumns, 3 * kTabStopColumns + 1);
+        EXPECT_EQ(doc.rightColumns, 5u);
+    }
+}
+
 } // namespace bendiff::core::render
@@ -0,0 +1,76 @@
+#include <diff_session.h>
+
+#include <gtest/gtest.h>
+
+#include <stop_token>
+
+namespace bendiff::core {
+namespace {
+
+DiffSession MakeSession()
+{
+    return DiffSession(LoadUtf8TextFromBytes("a\nb \nc\n", "left"), LoadUtf8TextFromBytes("a\nb\nx\n", "right"));
+}
+
+diff::DiffOptions CountingOptions(int& calls)
+{
+    diff::DiffOptions options;
+    options.control.progress = [&calls](double) { ++calls; };
+    return options;
+}
+
+} // namespace
+
+TEST(DiffSession, KeepsTheLoadedSides)
+{
+    const auto session = MakeSession();
+    EXPECT_EQ(session.left().lines, (TextLines{"a", "b ", "c"}));
+    EXPECT_EQ(session.right().lines, (TextLines{"a", "b", "x"}));
+}
+
+TEST(DiffSession, DiffsEachModeOnce)
+{
+    auto session = MakeSession();
+    EXPECT_FALSE(session.CachedDiff(diff::WhitespaceMode::Exact).has_value());
+
+    int calls = 0;
+    const auto exact = session.Diff(diff::WhitespaceMode::Exact, CountingOptions(calls));
+    const int afterFirst = calls;
+    EXPECT_GT(afterFirst, 0);
+    ASSERT_EQ(exact.hunks.size(), 1u);
+    EXPECT_EQ(exact.hunks[0].leftCount, 2);
+
+    const auto again = session.Diff(diff::WhitespaceMode::Exact, CountingOptions(calls));
+    EXPECT_EQ(calls, afterFirst);
+    ASSERT_EQ(again.hunks.size(), 1u);
+    EXPECT_EQ(again.hunks[0].leftCount, 2);
+
+    const auto trailing = session.Diff(diff::WhitespaceMode::IgnoreTrailing, CountingOptions(calls));
+    EXPECT_GT(calls, afterFirst);
+    ASSERT_EQ(trailing.hunks.size(), 1u);
+    EXPECT_EQ(trailing.hunks[0].leftCount, 1);
+
+    EXPECT_TRUE(session.CachedDiff(diff::WhitespaceMode::Exact).has_value());
+    EXPECT_TRUE(session.CachedDiff(diff::WhitespaceMode::IgnoreTrailing).has_value());
+    EXPECT_FALSE(session.CachedDiff(diff::WhitespaceMode::IgnoreAll).has_value());
+}
+
+TEST(DiffSession, DoesNotKeepCancelledDiffs)
+{
+    auto session = MakeSession();
+
+    std::stop_source stop;
+    stop.request_stop();
+    diff::DiffOptions options;
+    options.control.stop = stop.get_token();
+
+    const auto cancelled = session.Diff(diff::WhitespaceMode::Exact, options);
+    EXPECT_TRUE(cancelled.cancelled);
+    EXPECT_FALSE(session.CachedDiff(diff::WhitespaceMode::Exact).has_value());
+
+    const auto full = session.Diff(diff::WhitespaceMode::Exact, diff::DiffOptions{});
+    EXPECT_FALSE(full.cancelled);
+    EXPECT_TRUE(session.CachedDiff(diff::WhitespaceMode::Exact).has_value());
+}
+
+} // namespace bendiff::core
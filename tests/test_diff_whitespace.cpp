@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+
 namespace bendiff::core::diff {
 
 TEST(WhitespaceKeys, ExactKeepsWhitespaceDifferences)
@@ -39,4 +41,54 @@ TEST(WhitespaceKeys, IgnoreAllRemovesAllDefinedWhitespace)
     EXPECT_EQ(MakeComparisonKey("", WhitespaceMode::IgnoreAll), "");
 }
 
+TEST(WhitespaceKeys, KeysEqualMatchesComparingBuiltKeys)
+{
+    const std::string lines[] = {"", " ", "foo", "foo ", "f o o", "\tfoo\r", "fo", "foo\t\t", " f"};
+
+    for (const auto mode : {WhitespaceMode::Exact, WhitespaceMode::IgnoreTrailing, WhitespaceMode::IgnoreAll}) {
+        for (const auto& a : lines) {
+            for (const auto& b : lines) {
+                EXPECT_EQ(ComparisonKeysEqual(a, b, mode), MakeComparisonKey(a, mode) == MakeComparisonKey(b, mode))
+                    << "'" << a << "' vs '" << b << "' mode " << static_cast<int>(mode);
+            }
+        }
+    }
+}
+
+TEST(WhitespaceKeys, BorrowedKeysCompareLikeBuiltKeys)
+{
+    const std::string lines[] = {"", " ", "foo", "foo ", "f o o", "\tfoo\r", "fo", "foo\t\t", " f"};
+
+    for (const auto mode : {WhitespaceMode::Exact, WhitespaceMode::IgnoreTrailing, WhitespaceMode::IgnoreAll}) {
+        for (const auto& a : lines) {
+            const ComparisonKey ka(a, mode);
+            for (const auto& b : lines) {
+                const ComparisonKey kb(b, mode);
+                const bool equal = MakeComparisonKey(a, mode) == MakeComparisonKey(b, mode);
+                EXPECT_EQ(ka == kb, equal) << "'" << a << "' vs '" << b << "' mode " << static_cast<int>(mode);
+                if (equal) {
+                    EXPECT_EQ(ka.hash(), kb.hash());
+                }
+            }
+        }
+    }
+}
+
+TEST(WhitespaceKeys, BorrowedKeysViewTheLine)
+{
+    const std::string line = "  f o o \t";
+
+    const ComparisonKey exact(line, WhitespaceMode::Exact);
+    EXPECT_EQ(exact.text().data(), line.data());
+    EXPECT_EQ(exact.text(), line);
+
+    const ComparisonKey trailing(line, WhitespaceMode::IgnoreTrailing);
+    EXPECT_EQ(trailing.text().data(), line.data());
+    EXPECT_EQ(trailing.text(), "  f o o");
+
+    const ComparisonKey all(line, WhitespaceMode::IgnoreAll);
+    EXPECT_EQ(all.text().data(), line.data());
+    EXPECT_EQ(all, ComparisonKey("foo", WhitespaceMode::IgnoreAll));
+}
+
 } // namespace bendiff::core::diff
@@ -2,11 +2,15 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <map>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace fs = std::filesystem;
 
@@ -50,12 +54,12 @@ TEST(DirDiff, ProducesUnionAndClassifiesStatuses)
 
     // Stable sort guarantee.
     for (std::size_t i = 1; i < r.entries.size(); ++i) {
-        ASSERT_LE(r.entries[i - 1].relativePath, r.entries[i].relativePath);
+        ASSERT_LE(r.entries[i - 1].relativePath(), r.entries[i].relativePath());
     }
 
     std::map<std::string, bendiff::core::DirEntryStatus> byPath;
     for (const auto& e : r.entries) {
-        byPath[e.relativePath] = e.status;
+        byPath[std::string(e.relativePath())] = e.status;
     }
 
     EXPECT_EQ(byPath["left_only.txt"], bendiff::core::DirEntryStatus::LeftOnly);
@@ -93,7 +97,7 @@ TEST(DirDiff, UnreadableBestEffort)
 
     const auto r = bendiff::core::DiffDirectories(left, right);
     auto it = std::find_if(r.entries.begin(), r.entries.end(), [](const bendiff::core::DirEntry& e) {
-        return e.relativePath == "unreadable.txt";
+        return e.relativePath() == "unreadable.txt";
     });
     ASSERT_TRUE(it != r.entries.end());
     EXPECT_EQ(it->status, bendiff::core::DirEntryStatus::Unreadable);
@@ -107,3 +111,141 @@ TEST(DirDiff, UnreadableBestEffort)
     fs::remove_all(root);
 #endif
 }
+
+TEST(DirDiff, MetadataSettlesSameFileAndSizeMismatch)
+{
+#if defined(_WIN32)
+    GTEST_SKIP() << "Inode identity and chmod-based unreadability are POSIX-only";
+#else
+    const auto root = make_unique_temp_dir("bendiff_dir_diff_metadata");
+    const auto left = root / "left";
+    const auto right = root / "right";
+
+    // left/linked.txt is a symlink to right/linked.txt, as git difftool sets
+    // up for worktree files.
+    write_file(right / "linked.txt", "worktree\n");
+    fs::create_directories(left);
+    std::error_code ec;
+    fs::create_symlink(right / "linked.txt", left / "linked.txt", ec);
+    if (ec) {
+        fs::remove_all(root);
+        GTEST_SKIP() << "symlinks not supported here: " << ec.message();
+    }
+
+    // Different sizes: Different, even though the left side can't be read.
+    write_file(left / "sized.txt", "short\n");
+    write_file(right / "sized.txt", "much longer\n");
+    fs::permissions(left / "sized.txt", fs::perms::none, fs::perm_options::replace, ec);
+    ASSERT_FALSE(ec) << ec.message();
+
+    const auto r = bendiff::core::DiffDirectories(left, right);
+    std::map<std::string, bendiff::core::DirEntryStatus> byPath;
+    for (const auto& e : r.entries) {
+        byPath[std::string(e.relativePath())] = e.status;
+    }
+    EXPECT_EQ(byPath["linked.txt"], bendiff::core::DirEntryStatus::Same);
+    EXPECT_EQ(byPath["sized.txt"], bendiff::core::DirEntryStatus::Different);
+
+    fs::permissions(left / "sized.txt", fs::perms::owner_read | fs::perms::owner_write, fs::perm_options::replace, ec);
+    fs::remove_all(root);
+#endif
+}
+
+TEST(DirDiff, ResultDoesNotDependOnCompareThreads)
+{
+    const fs::path root = fixture_root();
+
+    const auto sequential = bendiff::core::DiffDirectories(root / "left", root / "right", {.compareThreads = 1});
+    const auto parallel = bendiff::core::DiffDirectories(root / "left", root / "right", {.compareThreads = 4});
+
+    ASSERT_EQ(parallel.entries.size(), sequential.entries.size());
+    for (std::size_t i = 0; i < sequential.entries.size(); ++i) {
+        EXPECT_EQ(parallel.entries[i].relativePath(), sequential.entries[i].relativePath());
+        EXPECT_EQ(parallel.entries[i].status, sequential.entries[i].status) << sequential.entries[i].relativePath();
+    }
+}
+
+TEST(DirDiff, EntriesShareThePathPoolInMergedOrder)
+{
+    const fs::path root = fixture_root();
+    const auto r = bendiff::core::DiffDirectories(root / "left", root / "right");
+
+    ASSERT_EQ(r.paths.size(), r.entries.size());
+    for (std::size_t i = 0; i < r.entries.size(); ++i) {
+        EXPECT_EQ(r.entries[i].relativePath().data(), r.paths[i].data());
+        EXPECT_EQ(r.entries[i].relativePath(), r.paths[i]);
+        if (i > 0) {
+            // Strictly increasing: a path on both sides appears once.
+            EXPECT_LT(r.entries[i - 1].relativePath(), r.entries[i].relativePath());
+        }
+    }
+
+    // Entries copied out of a result keep its pool alive.
+    std::vector<bendiff::core::DirEntry> entries;
+    {
+        const auto temporary = bendiff::core::DiffDirectories(root / "left", root / "right");
+        entries = temporary.entries;
+    }
+    ASSERT_EQ(entries.size(), r.entries.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        EXPECT_EQ(entries[i].relativePath(), r.entries[i].relativePath());
+    }
+}
+
+TEST(PerformanceSanity, DirDiffCompareStageScalesWithThreads)
+{
+    // Generated tree pair; BENDIFF_BENCH_DIR_FILES=100000 gives the full-size
+    // benchmark. Compare-stage timings are recorded per thread count, not
+    // asserted; the walks run on one thread and are timed apart.
+    std::size_t fileCount = 2'000;
+    if (const char* env = std::getenv("BENDIFF_BENCH_DIR_FILES")) {
+        fileCount = static_cast<std::size_t>(std::strtoull(env, nullptr, 10));
+    }
+
+    const auto root = make_unique_temp_dir("bendiff_dir_diff_bench");
+    const std::string body(4096, 'x');
+    for (std::size_t i = 0; i < fileCount; ++i) {
+        const std::string rel = "d" + std::to_string(i % 100) + "/f" + std::to_string(i) + ".txt";
+        write_file(root / "left" / rel, body + std::to_string(i));
+        // Every 10th file differs in its last bytes; every 50th is left-only.
+        if (i % 50 != 0) {
+            write_file(root / "right" / rel, body + std::to_string(i % 10 == 0 ? i + 1 : i));
+        }
+    }
+
+    // Powers of two up to the core count (and at least 4, since reads also
+    // overlap I/O latency on few cores).
+    std::vector<std::size_t> threadCounts = {1};
+    const std::size_t maxThreads = std::max<std::size_t>(4, std::thread::hardware_concurrency());
+    for (std::size_t t = 2; t <= maxThreads; t *= 2) {
+        threadCounts.push_back(t);
+    }
+
+    std::vector<bendiff::core::DirEntry> baseline;
+    for (const auto threads : threadCounts) {
+        const auto start = std::chrono::steady_clock::now();
+        const auto r = bendiff::core::DiffDirectories(root / "left",
+                                                      root / "right",
+                                                      {.compareThreads = threads, .walkThreads = 1});
+        // Everything but the compare stage: the walks and the path merge.
+        const auto walkTime = (std::chrono::steady_clock::now() - start) - r.compareTime;
+
+        ASSERT_EQ(r.entries.size(), fileCount);
+        if (baseline.empty()) {
+            baseline = r.entries;
+        } else {
+            for (std::size_t i = 0; i < baseline.size(); ++i) {
+                ASSERT_EQ(r.entries[i].relativePath(), baseline[i].relativePath());
+                ASSERT_EQ(r.entries[i].status, baseline[i].status) << baseline[i].relativePath();
+            }
+        }
+
+        const auto ms = [](auto d) {
+            return std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(d).count());
+        };
+        RecordProperty("threads_" + std::to_string(threads) + "_compare_ms", ms(r.compareTime));
+        RecordProperty("threads_" + std::to_string(threads) + "_walk_ms", ms(walkTime));
+    }
+
+    fs::remove_all(root);
+}
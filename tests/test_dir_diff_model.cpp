@@ -9,16 +9,16 @@ TEST(DirDiffModel, CanConstructDirDiffResult)
     result.rightRoot = "/tmp/right";
 
     bendiff::core::DirEntry same;
-    same.relativePath = "src/main.cpp";
+    same.paths = {"src/main.cpp"};
     same.status = bendiff::core::DirEntryStatus::Same;
     same.isBinaryHint = false;
 
     bendiff::core::DirEntry different;
-    different.relativePath = "README.md";
+    different.paths = {"README.md"};
     different.status = bendiff::core::DirEntryStatus::Different;
 
     bendiff::core::DirEntry leftOnly;
-    leftOnly.relativePath = "only_left.txt";
+    leftOnly.paths = {"only_left.txt"};
     leftOnly.status = bendiff::core::DirEntryStatus::LeftOnly;
 
     result.entries.push_back(same);
@@ -26,6 +26,7 @@ TEST(DirDiffModel, CanConstructDirDiffResult)
     result.entries.push_back(leftOnly);
 
     ASSERT_EQ(result.entries.size(), 3u);
+    EXPECT_EQ(result.entries[0].relativePath(), "src/main.cpp");
     EXPECT_EQ(result.entries[0].status, bendiff::core::DirEntryStatus::Same);
     EXPECT_EQ(result.entries[1].status, bendiff::core::DirEntryStatus::Different);
     EXPECT_EQ(result.entries[2].status, bendiff::core::DirEntryStatus::LeftOnly);
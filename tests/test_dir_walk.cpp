@@ -64,3 +64,102 @@ TEST(DirWalk, ListsAllFilesRecursivelyWithNormalizedSeparators)
 
     fs::remove_all(root);
 }
+
+TEST(DirWalk, ReturnsSortedPathsForAnyThreadCount)
+{
+    const auto root = make_unique_temp_dir("bendiff_dir_walk_parallel");
+
+    std::vector<std::string> expected;
+    for (int d = 0; d < 12; ++d) {
+        for (int sub = 0; sub < 3; ++sub) {
+            for (int f = 0; f < 7; ++f) {
+                const std::string rel = "d" + std::to_string(d) + "/s" + std::to_string(sub) + "/f" + std::to_string(f) + ".txt";
+                write_file(root / rel, rel);
+                expected.push_back(rel);
+            }
+        }
+        const std::string top = "top" + std::to_string(d);
+        write_file(root / top, top);
+        expected.push_back(top);
+    }
+    fs::create_directories(root / "empty" / "deeper");
+    std::sort(expected.begin(), expected.end());
+
+    for (const std::size_t threads : {std::size_t{1}, std::size_t{2}, std::size_t{8}}) {
+        EXPECT_EQ(bendiff::core::ListFilesRecursive(root, {.threads = threads}), expected) << threads << " threads";
+    }
+    EXPECT_EQ(bendiff::core::ListFilesRecursive(root), expected);
+
+    fs::remove_all(root);
+}
+
+TEST(DirWalk, ListsFileSymlinksButDoesNotFollowDirectorySymlinks)
+{
+    const auto root = make_unique_temp_dir("bendiff_dir_walk_links");
+
+    write_file(root / "real" / "a.txt", "a");
+    std::error_code ec;
+    fs::create_symlink("real/a.txt", root / "link.txt", ec);
+    if (ec) {
+        fs::remove_all(root);
+        GTEST_SKIP() << "symlinks not supported here: " << ec.message();
+    }
+    fs::create_directory_symlink("real", root / "linkdir", ec);
+    ASSERT_FALSE(ec) << ec.message();
+    fs::create_symlink("missing", root / "dangling", ec);
+    ASSERT_FALSE(ec) << ec.message();
+
+    EXPECT_EQ(bendiff::core::ListFilesRecursive(root), (std::vector<std::string>{"link.txt", "real/a.txt"}));
+
+    fs::remove_all(root);
+}
+
+TEST(DirWalk, MetadataListingMatchesPathsAndFollowsSymlinks)
+{
+    const auto root = make_unique_temp_dir("bendiff_dir_walk_metadata");
+
+    write_file(root / "real" / "a.txt", "alpha");
+    write_file(root / "b.txt", "");
+    std::error_code ec;
+    fs::create_symlink("real/a.txt", root / "link.txt", ec);
+    if (ec) {
+        fs::remove_all(root);
+        GTEST_SKIP() << "symlinks not supported here: " << ec.message();
+    }
+
+    const auto files = bendiff::core::ListFilesWithMetadata(root, {.threads = 2});
+    std::vector<std::string> paths;
+    for (const auto& f : files) {
+        paths.push_back(f.relativePath);
+        EXPECT_TRUE(f.metadata.valid) << f.relativePath;
+    }
+    EXPECT_EQ(paths, bendiff::core::ListFilesRecursive(root));
+    ASSERT_EQ(files.size(), 3u);
+
+    const auto& b = files[0];
+    const auto& link = files[1];
+    const auto& a = files[2];
+    EXPECT_EQ(a.metadata.size, 5u);
+    EXPECT_EQ(b.metadata.size, 0u);
+
+    // A symlink reports its target's stat, so both name the same file.
+    EXPECT_EQ(link.metadata.size, a.metadata.size);
+#if !defined(_WIN32)
+    EXPECT_TRUE(bendiff::core::IsSameFile(link.metadata, a.metadata));
+#endif
+    EXPECT_FALSE(bendiff::core::IsSameFile(a.metadata, b.metadata));
+
+    fs::remove_all(root);
+}
+
+TEST(DirWalk, MissingOrNonDirectoryRootListsNothing)
+{
+    const auto root = make_unique_temp_dir("bendiff_dir_walk_missing");
+    write_file(root / "file.txt", "x");
+
+    EXPECT_TRUE(bendiff::core::ListFilesRecursive(root / "nope").empty());
+    EXPECT_TRUE(bendiff::core::ListFilesRecursive(root / "file.txt").empty());
+    EXPECT_TRUE(bendiff::core::ListFilesRecursive(fs::path()).empty());
+
+    fs::remove_all(root);
+}
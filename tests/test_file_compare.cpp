@@ -72,3 +72,64 @@ TEST(FileCompare, MissingFileIsUnreadable)
 
     fs::remove_all(root);
 }
+
+TEST(FileCompare, DifferenceAfterTheFirstChunkIsFound)
+{
+    const auto root = make_unique_temp_dir("bendiff_file_compare_chunks");
+    const auto left = root / "left.bin";
+    const auto right = root / "right.bin";
+
+    // Larger than one read chunk, differing only in the last byte.
+    std::string bytes(1024 * 1024 + 17, 'x');
+    write_file(left, bytes);
+    write_file(right, bytes);
+    EXPECT_EQ(bendiff::core::CompareFilesBytewise(left, right), bendiff::core::FileCompareResult::Same);
+
+    bytes.back() = 'y';
+    write_file(right, bytes);
+    EXPECT_EQ(bendiff::core::CompareFilesBytewise(left, right), bendiff::core::FileCompareResult::Different);
+
+    fs::remove_all(root);
+}
+
+TEST(FileCompare, CompareAndHashRecordsHashesOnlyForFilesReadWhole)
+{
+    const auto root = make_unique_temp_dir("bendiff_file_compare_hash");
+    const auto left = root / "left.bin";
+    const auto right = root / "right.bin";
+
+    std::string bytes(1024 * 1024 + 17, 'x');
+    write_file(left, bytes);
+    write_file(right, bytes);
+    auto r = bendiff::core::CompareAndHashFiles(left, right);
+    EXPECT_EQ(r.result, bendiff::core::FileCompareResult::Same);
+    ASSERT_TRUE(r.leftHash && r.rightHash);
+    EXPECT_EQ(*r.leftHash, bendiff::core::HashBytes(bytes));
+    EXPECT_EQ(*r.rightHash, *r.leftHash);
+
+    // A difference in the first chunk stops the read: nothing to record.
+    std::string early = bytes;
+    early.front() = 'y';
+    write_file(right, early);
+    r = bendiff::core::CompareAndHashFiles(left, right);
+    EXPECT_EQ(r.result, bendiff::core::FileCompareResult::Different);
+    EXPECT_FALSE(r.leftHash.has_value());
+    EXPECT_FALSE(r.rightHash.has_value());
+
+    // A difference in the last chunk is only found at the end: both hashed.
+    std::string late = bytes;
+    late.back() = 'y';
+    write_file(right, late);
+    r = bendiff::core::CompareAndHashFiles(left, right);
+    EXPECT_EQ(r.result, bendiff::core::FileCompareResult::Different);
+    ASSERT_TRUE(r.leftHash && r.rightHash);
+    EXPECT_EQ(*r.rightHash, bendiff::core::HashBytes(late));
+
+    // Different sizes: nothing is read.
+    write_file(right, "short");
+    r = bendiff::core::CompareAndHashFiles(left, right);
+    EXPECT_EQ(r.result, bendiff::core::FileCompareResult::Different);
+    EXPECT_FALSE(r.leftHash.has_value());
+
+    fs::remove_all(root);
+}
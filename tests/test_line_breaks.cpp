@@ -0,0 +1,111 @@
+#include <line_breaks.h>
+#include <loaded_text_file.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bendiff::core {
+
+namespace {
+
+// Random text over a small alphabet rich in line breaks, so CR, LF and CRLF
+// land on every position relative to the vector block boundaries.
+std::string RandomText(std::mt19937& rng, std::size_t size)
+{
+    static constexpr char kAlphabet[] = {'a', 'b', ' ', '\n', '\r', '\n', '\r'};
+    std::uniform_int_distribution<std::size_t> pick(0, sizeof(kAlphabet) - 1);
+    std::string out(size, '\0');
+    for (auto& c : out) {
+        c = kAlphabet[pick(rng)];
+    }
+    return out;
+}
+
+// The split contract, spelled out one byte at a time.
+std::vector<std::string> ReferenceSplit(std::string_view text, bool& hadFinalNewline)
+{
+    std::vector<std::string> out;
+    hadFinalNewline = false;
+    if (text.empty()) {
+        return out;
+    }
+    std::string current;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n' || text[i] == '\r') {
+            if (text[i] == '\r' && i + 1 < text.size() && text[i + 1] == '\n') {
+                ++i;
+            }
+            out.push_back(current);
+            current.clear();
+        } else {
+            current.push_back(text[i]);
+        }
+    }
+    hadFinalNewline = text.back() == '\n' || text.back() == '\r';
+    if (!hadFinalNewline) {
+        out.push_back(current);
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(LineBreaks, KernelsAgreeWithScalar)
+{
+    std::mt19937 rng(42);
+    for (int iter = 0; iter < 2'000; ++iter) {
+        const auto text = RandomText(rng, static_cast<std::size_t>(iter % 200));
+
+        std::vector<std::size_t> expected;
+        FindLineBreaksWith(LineBreakKernel::Scalar, text, expected);
+        for (const auto kernel : AvailableLineBreakKernels()) {
+            std::vector<std::size_t> actual;
+            FindLineBreaksWith(kernel, text, actual);
+            ASSERT_EQ(actual, expected) << "kernel " << static_cast<int>(kernel) << " iteration " << iter;
+        }
+    }
+}
+
+TEST(LineBreaks, SplitMatchesReferenceOnMixedLineEndings)
+{
+    std::mt19937 rng(7);
+    for (int iter = 0; iter < 2'000; ++iter) {
+        const auto text = RandomText(rng, static_cast<std::size_t>(iter % 150));
+
+        bool hadFinalNewline = false;
+        const auto expected = ReferenceSplit(text, hadFinalNewline);
+        const auto actual = SplitLinesNormalizeNewlines(text);
+        ASSERT_EQ(actual.lines, expected) << "iteration " << iter;
+        ASSERT_EQ(actual.hadFinalNewline, hadFinalNewline) << "iteration " << iter;
+    }
+}
+
+TEST(PerformanceSanity, LineBreakScanThroughput)
+{
+    // Records MB/s per kernel on source-like text (~40 byte lines). No timing
+    // assertions (to keep the test stable across machines/configs).
+    std::string text;
+    while (text.size() < 32 * 1024 * 1024) {
+        text += "        out.push_back(base + offset);\n";
+    }
+
+    for (const auto kernel : AvailableLineBreakKernels()) {
+        std::vector<std::size_t> breaks;
+        const auto t0 = std::chrono::steady_clock::now();
+        FindLineBreaksWith(kernel, text, breaks);
+        const auto t1 = std::chrono::steady_clock::now();
+        EXPECT_EQ(breaks.size(), static_cast<std::size_t>(std::ranges::count(text, '\n')));
+
+        const double seconds = std::max(std::chrono::duration<double>(t1 - t0).count(), 1e-9);
+        RecordProperty("kernel_" + std::to_string(static_cast<int>(kernel)) + "_mb_per_s",
+                       static_cast<int>(static_cast<double>(text.size()) / (1024.0 * 1024.0) / seconds));
+    }
+}
+
+} // namespace bendiff::core
@@ -6,6 +6,7 @@
 #include <fstream>
 #include <chrono>
 #include <string>
+#include <vector>
 
 namespace bendiff::core {
 
@@ -245,4 +246,45 @@ TEST(IsUnsupportedText, TrueOnlyForNotUtf8)
     EXPECT_TRUE(IsUnsupportedText(f));
 }
 
+TEST(LoadUtf8TextFromBytes, HashesEveryLineForEveryMode)
+{
+    const auto loaded = LoadUtf8TextFromBytes("a \nb\tc\r\n\nlast", "mem");
+    ASSERT_EQ(loaded.status, LoadStatus::Ok);
+    ASSERT_EQ(loaded.hashes.size(), loaded.lines.size());
+
+    for (const auto mode : {diff::WhitespaceMode::Exact, diff::WhitespaceMode::IgnoreTrailing, diff::WhitespaceMode::IgnoreAll}) {
+        const auto hashes = loaded.hashes.ForMode(mode);
+        for (std::size_t i = 0; i < loaded.lines.size(); ++i) {
+            EXPECT_EQ(hashes[i], diff::HashComparisonKey(loaded.lines[i], mode)) << "line " << i;
+        }
+    }
+}
+
+TEST(LoadUtf8TextFromBytes, LargeInputSplitsAcrossChunks)
+{
+    // Several pipeline chunks, with a CRLF and a multi-byte character on
+    // every possible alignment, and one line longer than a chunk.
+    std::string bytes;
+    std::vector<std::string> expected;
+    for (int i = 0; bytes.size() < 1'500'000; ++i) {
+        std::string line = "line " + std::to_string(i) + std::string(static_cast<std::size_t>(i % 7), 'x') + "\xE2\x82\xAC";
+        if (i == 1000) {
+            line += std::string(600'000, 'y');
+        }
+        bytes += line;
+        bytes += (i % 3 == 0) ? "\r\n" : (i % 3 == 1 ? "\n" : "\r");
+        expected.push_back(line);
+    }
+
+    const auto loaded = LoadUtf8TextFromBytes(bytes, "mem");
+    ASSERT_EQ(loaded.status, LoadStatus::Ok);
+    EXPECT_TRUE(loaded.hadFinalNewline);
+    EXPECT_EQ(loaded.lines, expected);
+    EXPECT_EQ(loaded.hashes.size(), expected.size());
+
+    // Invalid UTF-8 far from the start is still caught.
+    bytes[bytes.size() - 10] = static_cast<char>(0xFF);
+    EXPECT_EQ(LoadUtf8TextFromBytes(bytes, "mem").status, LoadStatus::NotUtf8);
+}
+
 } // namespace bendiff::core
@@ -0,0 +1,167 @@
+#include <mapped_file.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace bendiff::core {
+
+namespace {
+
+fs::path make_unique_temp_dir(const std::string& prefix)
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    const auto stamp = std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+
+    fs::path dir = fs::temp_directory_path() / (prefix + "_" + stamp);
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+void write_file(const fs::path& p, const std::string& bytes)
+{
+    std::ofstream out(p, std::ios::binary);
+    ASSERT_TRUE(out.good()) << p;
+    out << bytes;
+}
+
+} // namespace
+
+TEST(MappedFile, ReadsRegularFile)
+{
+    const auto dir = make_unique_temp_dir("bendiff_mapped_regular");
+    const std::string content(200'000, 'x');
+    write_file(dir / "f.txt", content);
+
+    MappedFile f;
+    ASSERT_EQ(f.Open(dir / "f.txt"), FileReadStatus::Ok);
+    EXPECT_EQ(f.bytes(), content);
+#if !defined(_WIN32)
+    EXPECT_TRUE(f.isMapped());
+#endif
+
+    fs::remove_all(dir);
+}
+
+TEST(MappedFile, EmptyFileHasNoBytes)
+{
+    const auto dir = make_unique_temp_dir("bendiff_mapped_empty");
+    write_file(dir / "empty.txt", "");
+
+    MappedFile f;
+    ASSERT_EQ(f.Open(dir / "empty.txt"), FileReadStatus::Ok);
+    EXPECT_TRUE(f.bytes().empty());
+
+    fs::remove_all(dir);
+}
+
+TEST(MappedFile, MissingFileIsNotFound)
+{
+    const auto dir = make_unique_temp_dir("bendiff_mapped_missing");
+
+    MappedFile f;
+    EXPECT_EQ(f.Open(dir / "nope.txt"), FileReadStatus::NotFound);
+    EXPECT_TRUE(f.bytes().empty());
+
+    fs::remove_all(dir);
+}
+
+TEST(MappedFile, DirectoryIsUnreadable)
+{
+    const auto dir = make_unique_temp_dir("bendiff_mapped_dir");
+
+    MappedFile f;
+    EXPECT_EQ(f.Open(dir), FileReadStatus::Unreadable);
+
+    fs::remove_all(dir);
+}
+
+#if !defined(_WIN32)
+TEST(MappedFile, SpecialFilesAreReadInsteadOfMapped)
+{
+    MappedFile f;
+    ASSERT_EQ(f.Open("/dev/null"), FileReadStatus::Ok);
+    EXPECT_FALSE(f.isMapped());
+    EXPECT_TRUE(f.bytes().empty());
+}
+#endif
+
+TEST(MappedFile, MoveKeepsBytes)
+{
+    const auto dir = make_unique_temp_dir("bendiff_mapped_move");
+    write_file(dir / "f.txt", "hello");
+
+    MappedFile a;
+    ASSERT_EQ(a.Open(dir / "f.txt"), FileReadStatus::Ok);
+    MappedFile b = std::move(a);
+    EXPECT_EQ(b.bytes(), "hello");
+
+    fs::remove_all(dir);
+}
+
+TEST(SequentialFile, ReadsInChunksUntilEndOfFile)
+{
+    const auto root = make_unique_temp_dir("bendiff_sequential_file");
+    const auto path = root / "data.bin";
+    std::string bytes;
+    for (int i = 0; i < 1000; ++i) {
+        bytes += static_cast<char>(i % 251);
+    }
+    write_file(path, bytes);
+
+    SequentialFile file;
+    ASSERT_EQ(file.Open(path), FileReadStatus::Ok);
+    EXPECT_EQ(file.size(), std::optional<std::uint64_t>(bytes.size()));
+
+    std::string read;
+    char chunk[300];
+    while (true) {
+        const auto n = file.Read(chunk);
+        ASSERT_TRUE(n.has_value());
+        read.append(chunk, *n);
+        if (*n < sizeof(chunk)) {
+            break;
+        }
+    }
+    EXPECT_EQ(read, bytes);
+
+    EXPECT_EQ(file.Open(root / "missing"), FileReadStatus::NotFound);
+    EXPECT_EQ(file.Open(root), FileReadStatus::Unreadable);
+
+    fs::remove_all(root);
+}
+
+TEST(SequentialFile, ReadAllReadsTheRestOfTheFile)
+{
+    const auto root = make_unique_temp_dir("bendiff_sequential_file_all");
+    const auto path = root / "data.bin";
+    const std::string bytes(700 * 1024, 'q');
+    write_file(path, bytes);
+
+    SequentialFile file;
+    ASSERT_EQ(file.Open(path), FileReadStatus::Ok);
+    char head[10];
+    ASSERT_EQ(file.Read(head), std::optional<std::size_t>(sizeof(head)));
+    EXPECT_EQ(file.ReadAll(), std::optional<std::string>(bytes.substr(sizeof(head))));
+
+#if defined(__linux__)
+    // No reported size: read in growing steps.
+    ASSERT_EQ(file.Open("/proc/self/status"), FileReadStatus::Ok);
+    const auto status = file.ReadAll();
+    ASSERT_TRUE(status.has_value());
+    EXPECT_NE(status->find("Name:"), std::string::npos);
+#endif
+
+    fs::remove_all(root);
+}
+
+} // namespace bendiff::core
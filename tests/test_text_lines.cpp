@@ -0,0 +1,84 @@
+#include <text_lines.h>
+
+#include <diff/diff.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace bendiff::core {
+
+TEST(TextLines, DefaultIsEmpty)
+{
+    const TextLines lines;
+    EXPECT_TRUE(lines.empty());
+    EXPECT_EQ(lines.size(), 0u);
+    EXPECT_EQ(lines.begin(), lines.end());
+}
+
+TEST(TextLines, BuilderKeepsEmptyLines)
+{
+    TextLines::Builder builder;
+    builder.Append("a");
+    builder.Append("");
+    builder.Append("bc");
+    const auto lines = builder.Finish();
+
+    EXPECT_EQ(lines, (std::vector<std::string>{"a", "", "bc"}));
+    EXPECT_EQ(builder.size(), 0u);
+}
+
+TEST(TextLines, LinesAreViewsIntoOneBuffer)
+{
+    const TextLines lines = {"ab", "c", "def"};
+
+    EXPECT_EQ(lines[1].data(), lines[0].data() + 2);
+    EXPECT_EQ(lines[2].data(), lines[1].data() + 1);
+}
+
+TEST(TextLines, CopiesShareStorage)
+{
+    TextLines copy;
+    {
+        const TextLines original(std::vector<std::string>{"x", "y"});
+        copy = original;
+        EXPECT_EQ(copy[0].data(), original[0].data());
+    }
+    EXPECT_EQ(copy, (std::vector<std::string>{"x", "y"}));
+}
+
+TEST(TextLines, IteratorsOutliveTheirListWhileACopyRemains)
+{
+    TextLines copy;
+    TextLines::const_iterator it;
+    {
+        const TextLines original = {"x", "y"};
+        copy = original;
+        it = original.begin();
+    }
+    EXPECT_EQ(*it, "x");
+    EXPECT_EQ(it[1], "y");
+    EXPECT_EQ(it + 2, copy.end());
+}
+
+TEST(TextLines, DiffLinesMatchesStringOverload)
+{
+    const std::vector<std::string> left = {"a", "b ", "c", "d"};
+    const std::vector<std::string> right = {"a", "b", "x", "d", "e"};
+
+    for (const auto mode : {diff::WhitespaceMode::Exact, diff::WhitespaceMode::IgnoreTrailing}) {
+        const auto fromStrings = diff::DiffLines(left, right, mode);
+        const auto fromLines = diff::DiffLines(TextLines(left), TextLines(right), mode);
+
+        ASSERT_EQ(fromLines.hunks.size(), fromStrings.hunks.size());
+        for (std::size_t i = 0; i < fromLines.hunks.size(); ++i) {
+            EXPECT_EQ(fromLines.hunks[i].leftStart, fromStrings.hunks[i].leftStart);
+            EXPECT_EQ(fromLines.hunks[i].leftCount, fromStrings.hunks[i].leftCount);
+            EXPECT_EQ(fromLines.hunks[i].rightStart, fromStrings.hunks[i].rightStart);
+            EXPECT_EQ(fromLines.hunks[i].rightCount, fromStrings.hunks[i].rightCount);
+        }
+    }
+}
+
+} // namespace bendiff::core
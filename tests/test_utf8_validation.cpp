@@ -0,0 +1,186 @@
+#include <utf8_validation.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <string>
+
+namespace bendiff::core {
+
+namespace {
+
+const char* KernelName(Utf8Kernel kernel)
+{
+    switch (kernel) {
+        case Utf8Kernel::Scalar:
+            return "scalar";
+        case Utf8Kernel::Sse4:
+            return "sse4";
+        case Utf8Kernel::Avx2:
+            return "avx2";
+    }
+    return "?";
+}
+
+// Appends one valid code point of 1-4 bytes.
+void AppendCodePoint(std::mt19937& rng, std::string& out)
+{
+    std::uniform_int_distribution<int> width(1, 4);
+    std::uint32_t cp = 0;
+    switch (width(rng)) {
+        case 1:
+            cp = std::uniform_int_distribution<std::uint32_t>(0x00, 0x7F)(rng);
+            out.push_back(static_cast<char>(cp));
+            return;
+        case 2:
+            cp = std::uniform_int_distribution<std::uint32_t>(0x80, 0x7FF)(rng);
+            out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+            break;
+        case 3:
+            do {
+                cp = std::uniform_int_distribution<std::uint32_t>(0x800, 0xFFFF)(rng);
+            } while (cp >= 0xD800 && cp <= 0xDFFF);
+            out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            break;
+        default:
+            cp = std::uniform_int_distribution<std::uint32_t>(0x10000, 0x10FFFF)(rng);
+            out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            break;
+    }
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+}
+
+// Mostly valid text with a few random byte mutations (or none), so roughly
+// half the samples are valid and the invalid ones fail in varied ways.
+std::string RandomSample(std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> codePoints(0, 80);
+    std::uniform_int_distribution<int> mutations(-3, 3);
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    std::string out;
+    const int count = codePoints(rng);
+    for (int i = 0; i < count; ++i) {
+        AppendCodePoint(rng, out);
+    }
+
+    for (int m = mutations(rng); m > 0 && !out.empty(); --m) {
+        std::uniform_int_distribution<std::size_t> pos(0, out.size() - 1);
+        switch (byte(rng) % 3) {
+            case 0:
+                out[pos(rng)] = static_cast<char>(byte(rng));
+                break;
+            case 1:
+                out.erase(pos(rng), 1);
+                break;
+            default:
+                out.insert(out.begin() + static_cast<std::ptrdiff_t>(pos(rng)), static_cast<char>(byte(rng)));
+                break;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(Utf8Validation, ScalarIsAlwaysAvailable)
+{
+    const auto kernels = AvailableUtf8Kernels();
+    ASSERT_FALSE(kernels.empty());
+    EXPECT_EQ(kernels.front(), Utf8Kernel::Scalar);
+    EXPECT_EQ(BestUtf8Kernel(), kernels.back());
+}
+
+TEST(Utf8Validation, KernelsAgreeOnEdgeCases)
+{
+    const std::string cases[] = {
+        "",
+        "plain ascii",
+        "\xC2\xA2",
+        "\xE2\x82\xAC",
+        "\xF0\x9F\x98\x80",
+        "\xEF\xBF\xBF",     // U+FFFF
+        "\xF4\x8F\xBF\xBF", // U+10FFFF
+        "\x80",
+        "\xC2",
+        "\xC0\xAF",         // overlong 2
+        "\xE0\x80\xAF",     // overlong 3
+        "\xF0\x80\x80\xAF", // overlong 4
+        "\xED\xA0\x80",     // surrogate
+        "\xF4\x90\x80\x80", // above U+10FFFF
+        "\xF5\x80\x80\x80",
+        "\xFF",
+        "\xE2\x82",
+        "\xF0\x9F\x98",
+    };
+
+    for (const auto kernel : AvailableUtf8Kernels()) {
+        for (const auto& c : cases) {
+            // Shift each case across block boundaries, and cut it off there.
+            for (std::size_t pad = 0; pad < 70; ++pad) {
+                const std::string s = std::string(pad, 'a') + c;
+                SCOPED_TRACE(std::string(KernelName(kernel)) + " pad " + std::to_string(pad));
+                EXPECT_EQ(IsValidUtf8With(kernel, s), IsValidUtf8With(Utf8Kernel::Scalar, s));
+                EXPECT_EQ(IsValidUtf8With(kernel, s + "tail"), IsValidUtf8With(Utf8Kernel::Scalar, s + "tail"));
+            }
+        }
+    }
+}
+
+TEST(Utf8Validation, FuzzKernelsAgainstScalar)
+{
+    std::mt19937 rng(1234);
+    int valid = 0;
+    for (int iter = 0; iter < 50'000; ++iter) {
+        const auto s = RandomSample(rng);
+        const bool expected = IsValidUtf8With(Utf8Kernel::Scalar, s);
+        valid += expected ? 1 : 0;
+        for (const auto kernel : AvailableUtf8Kernels()) {
+            ASSERT_EQ(IsValidUtf8With(kernel, s), expected) << KernelName(kernel) << " iteration " << iter;
+        }
+    }
+
+    // The generator must exercise both outcomes.
+    EXPECT_GT(valid, 5'000);
+    EXPECT_LT(valid, 45'000);
+}
+
+TEST(PerformanceSanity, Utf8ValidationThroughput)
+{
+    // Records MB/s per kernel for plain ASCII and for mixed-width text. No
+    // timing assertions (to keep the test stable across machines/configs).
+    constexpr std::size_t kBytes = 32 * 1024 * 1024;
+
+    std::mt19937 rng(5);
+    std::string ascii;
+    std::string mixed;
+    ascii.reserve(kBytes);
+    mixed.reserve(kBytes + 4);
+    while (ascii.size() < kBytes) {
+        ascii += "    return IsValidUtf8With(BestUtf8Kernel(), bytes);\n";
+    }
+    while (mixed.size() < kBytes) {
+        AppendCodePoint(rng, mixed);
+    }
+
+    for (const auto kernel : AvailableUtf8Kernels()) {
+        for (const auto* input : {&ascii, &mixed}) {
+            const auto t0 = std::chrono::steady_clock::now();
+            const bool ok = IsValidUtf8With(kernel, *input);
+            const auto t1 = std::chrono::steady_clock::now();
+            EXPECT_TRUE(ok);
+
+            const double seconds = std::chrono::duration<double>(t1 - t0).count();
+            const double mbPerSecond = static_cast<double>(input->size()) / (1024.0 * 1024.0) / std::max(seconds, 1e-9);
+            RecordProperty(std::string(KernelName(kernel)) + (input == &ascii ? "_ascii_mb_per_s" : "_mixed_mb_per_s"),
+                           static_cast<int>(mbPerSecond));
+        }
+    }
+}
+
+} // namespace bendiff::core